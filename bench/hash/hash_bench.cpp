@@ -0,0 +1,299 @@
+// Throughput and quality numbers for the string hashes of the hash library.
+//
+//   hash_bench [--hasher NAME] [--table-size N] [--keys N] [--time MS] [--no-speed] [--no-quality]
+//
+// Speed is measured for keys from 1 B to 1 MiB. Small keys are taken from rotating offsets of a buffer that fits in
+// L2, so the numbers show hashing cost and not cache misses. Cycles are TSC reference cycles, which tick at the
+// nominal frequency and not the current core clock.
+//
+// Quality is measured as the bucket distribution of a few key sets in a table of the given size, and as the avalanche
+// bias: the probability that flipping one input bit flips a given output bit, ideally 0.5 for every pair.
+
+#include "crc32c.h"
+#include "fnv1a.h"
+#include "murmur.h"
+#include "siphash.h"
+#include "xxhash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPPUTILS_BENCH_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace {
+
+struct Hasher {
+    std::string_view name;
+    unsigned bits;
+    uint64_t (*function)(std::string_view);
+};
+
+constexpr hash::SipKey BenchKey{0x0706050403020100, 0x0f0e0d0c0b0a0908};
+
+const Hasher Hashers[] = {
+    {"fnv1a32", 32, [](std::string_view key) -> uint64_t { return hash::fnv1a<uint32_t>(key); }},
+    {"fnv1a64", 64, [](std::string_view key) -> uint64_t { return hash::fnv1a<uint64_t>(key); }},
+    {"murmur3_32", 32, [](std::string_view key) -> uint64_t { return hash::murmurHash3(key); }},
+    {"murmur3_x64", 64,
+     [](std::string_view key) -> uint64_t { return hash::detail::murmurHash3x64(key.begin(), key.end(), 0).first; }},
+    {"xxh3", 64, [](std::string_view key) -> uint64_t { return hash::xxh3(key); }},
+    {"siphash13", 64, [](std::string_view key) -> uint64_t { return hash::sipHash13(key, BenchKey); }},
+    {"siphash24", 64, [](std::string_view key) -> uint64_t { return hash::sipHash24(key, BenchKey); }},
+    {"crc32c", 32, [](std::string_view key) -> uint64_t { return hash::crc32c(key); }},
+};
+
+struct Options {
+    std::string_view hasher;
+    size_t tableSize = size_t(1) << 16;
+    size_t keys = 0;
+    double seconds = 0.05;
+    bool speed = true;
+    bool quality = true;
+};
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        const auto value = [&]() -> std::string_view {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + std::string(argument));
+            }
+            return argv[++i];
+        };
+        const auto number = [&]() -> size_t {
+            const std::string text(value());
+            size_t used = 0;
+            const unsigned long long result = std::stoull(text, &used);
+            if (used != text.size() || result == 0) {
+                throw std::invalid_argument("Expected a positive number for " + std::string(argument));
+            }
+            return static_cast<size_t>(result);
+        };
+
+        if (argument == "--hasher") {
+            options.hasher = value();
+        } else if (argument == "--table-size") {
+            options.tableSize = number();
+        } else if (argument == "--keys") {
+            options.keys = number();
+        } else if (argument == "--time") {
+            options.seconds = static_cast<double>(number()) / 1000;
+        } else if (argument == "--no-speed") {
+            options.speed = false;
+        } else if (argument == "--no-quality") {
+            options.quality = false;
+        } else {
+            throw std::invalid_argument("Unknown argument " + std::string(argument));
+        }
+    }
+    if (options.tableSize < 2) {
+        throw std::invalid_argument("The table needs at least 2 buckets");
+    }
+    if (options.keys == 0) {
+        options.keys = options.tableSize;
+    }
+    return options;
+}
+
+std::string randomBytes(size_t size, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::string bytes(size, '\0');
+    for (char& byte : bytes) {
+        byte = static_cast<char>(random());
+    }
+    return bytes;
+}
+
+uint64_t readCycles() {
+#ifdef CPPUTILS_BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Keeps the compiler from dropping the hashes
+volatile uint64_t sink;
+
+void benchmarkSpeed(const std::vector<const Hasher*>& hashers, const Options& options) {
+    constexpr size_t MaxKeySize = size_t(1) << 20;
+    constexpr size_t Window = size_t(64) << 10;
+    const std::string buffer = randomBytes(MaxKeySize + Window, 1);
+
+    printf("%-12s %10s %12s %14s %14s\n", "hasher", "key size", "GB/s", "Mhash/s", "cycles/hash");
+    for (const Hasher* hasher : hashers) {
+        for (size_t size = 1; size <= MaxKeySize; size *= size < 64 ? 2 : 4) {
+            const size_t offsets = size < Window ? Window - size : 1;
+            uint64_t result = 0;
+            size_t count = 0;
+            const auto hashKeys = [&](size_t iterations) {
+                for (size_t i = 0; i < iterations; ++i, ++count) {
+                    result ^= hasher->function(std::string_view(buffer).substr((count * 64) % offsets, size));
+                }
+            };
+
+            hashKeys(std::max<size_t>(1, (size_t(1) << 20) / size));
+
+            size_t iterations = std::max<size_t>(1, (size_t(1) << 16) / size);
+            double seconds = 0;
+            uint64_t cycles = 0;
+            for (;;) {
+                const auto start = std::chrono::steady_clock::now();
+                const uint64_t startCycles = readCycles();
+                hashKeys(iterations);
+                cycles = readCycles() - startCycles;
+                seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (seconds >= options.seconds) {
+                    break;
+                }
+                iterations *= seconds < options.seconds / 8 ? 8 : 2;
+            }
+            sink = result;
+
+            const double hashes = static_cast<double>(iterations);
+            printf("%-12.*s %10zu %12.3f %14.2f", static_cast<int>(hasher->name.size()), hasher->name.data(), size,
+                   hashes * static_cast<double>(size) / seconds / 1e9, hashes / seconds / 1e6);
+#ifdef CPPUTILS_BENCH_TSC
+            printf(" %14.1f\n", static_cast<double>(cycles) / hashes);
+#else
+            printf(" %14s\n", "-");
+#endif
+        }
+    }
+    printf("\n");
+}
+
+std::vector<std::string> keySet(std::string_view name, size_t count) {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    std::mt19937_64 random(2);
+    for (size_t i = 0; i < count; ++i) {
+        if (name == "sequential") {
+            std::string key(8, '\0');
+            for (size_t byte = 0; byte < 8; ++byte) {
+                key[byte] = static_cast<char>(static_cast<uint64_t>(i) >> (8 * byte));
+            }
+            keys.push_back(std::move(key));
+        } else if (name == "text") {
+            keys.push_back("user:" + std::to_string(i));
+        } else {
+            keys.push_back(randomBytes(16, random()));
+        }
+    }
+    return keys;
+}
+
+// Chi-squared of the bucket counts divided by its expectation, which is close to 1 for a uniform hash, the largest
+// bucket and the share of empty buckets
+void bucketDistribution(const std::vector<const Hasher*>& hashers, const Options& options) {
+    const double load = static_cast<double>(options.keys) / static_cast<double>(options.tableSize);
+    printf("Bucket distribution, %zu keys in %zu buckets\n", options.keys, options.tableSize);
+    printf("%-12s %12s %12s %12s %12s\n", "hasher", "keys", "chi2 ratio", "max bucket", "empty");
+
+    for (const std::string_view set : {"sequential", "text", "random"}) {
+        const std::vector<std::string> keys = keySet(set, options.keys);
+        for (const Hasher* hasher : hashers) {
+            std::vector<uint32_t> buckets(options.tableSize);
+            for (const std::string& key : keys) {
+                ++buckets[hasher->function(key) % options.tableSize];
+            }
+
+            double chiSquared = 0;
+            uint32_t largest = 0;
+            size_t empty = 0;
+            for (const uint32_t count : buckets) {
+                chiSquared += (count - load) * (count - load) / load;
+                largest = std::max(largest, count);
+                empty += count == 0;
+            }
+
+            printf("%-12.*s %12.*s %12.3f %12u %11.1f%%\n", static_cast<int>(hasher->name.size()),
+                   hasher->name.data(), static_cast<int>(set.size()), set.data(),
+                   chiSquared / static_cast<double>(options.tableSize - 1), largest,
+                   100.0 * static_cast<double>(empty) / static_cast<double>(options.tableSize));
+        }
+    }
+    printf("Uniform: chi2 ratio 1.000, %.1f%% empty\n\n", 100.0 * std::exp(-load));
+}
+
+void avalanche(const std::vector<const Hasher*>& hashers) {
+    constexpr size_t KeySize = 16;
+    constexpr size_t Samples = 10000;
+    constexpr size_t InputBits = KeySize * 8;
+
+    printf("Avalanche bias over %zu random %zu byte keys, 0 is ideal\n", Samples, KeySize);
+    printf("%-12s %12s %12s\n", "hasher", "mean", "worst");
+
+    const std::vector<std::string> keys = keySet("random", Samples);
+    for (const Hasher* hasher : hashers) {
+        std::vector<uint32_t> flips(InputBits * hasher->bits);
+        for (std::string key : keys) {
+            const uint64_t original = hasher->function(key);
+            for (size_t bit = 0; bit < InputBits; ++bit) {
+                key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+                const uint64_t changed = original ^ hasher->function(key);
+                key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+                for (unsigned output = 0; output < hasher->bits; ++output) {
+                    flips[bit * hasher->bits + output] += (changed >> output) & 1;
+                }
+            }
+        }
+
+        double total = 0;
+        double worst = 0;
+        for (const uint32_t count : flips) {
+            const double bias = std::abs(2.0 * count / Samples - 1.0);
+            total += bias;
+            worst = std::max(worst, bias);
+        }
+        printf("%-12.*s %12.4f %12.4f\n", static_cast<int>(hasher->name.size()), hasher->name.data(),
+               total / static_cast<double>(flips.size()), worst);
+    }
+    printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = parseOptions(argc, argv);
+
+        std::vector<const Hasher*> hashers;
+        for (const Hasher& hasher : Hashers) {
+            if (options.hasher.empty() || options.hasher == hasher.name) {
+                hashers.push_back(&hasher);
+            }
+        }
+        if (hashers.empty()) {
+            throw std::invalid_argument("Unknown hasher " + std::string(options.hasher));
+        }
+
+        if (options.speed) {
+            benchmarkSpeed(hashers, options);
+        }
+        if (options.quality) {
+            bucketDistribution(hashers, options);
+            avalanche(hashers);
+        }
+    } catch (const std::exception& exception) {
+        fprintf(stderr, "%s\n", exception.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "dispatch.h"
+#include "fnv1a.h"
+#include "hash_util.h"
+#include "murmur.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <concepts>
+#include <span>
+#include <stdint.h>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(CPPUTILS_HASH_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace hash {
+namespace detail {
+namespace batch {
+
+// Key data for one group of SIMD lanes
+constexpr size_t MaxLanes = 16;
+
+struct Group {
+    const uint8_t* data[MaxLanes];
+    uint32_t length[MaxLanes];
+};
+
+// Below this average key length per group the out of order core overlapping independent scalar hashes wins over
+// filling vector lanes
+constexpr size_t MinimumSimdLength = 32;
+
+using MurmurGroupFunction = void (*)(const Group& group, uint32_t seed, uint32_t* out);
+using FnvGroupFunction = void (*)(const Group& group, uint32_t* out);
+
+// Group kernels of one instruction set, one lane means hashing a key at a time
+struct GroupKernels {
+    size_t lanes;
+    MurmurGroupFunction murmur;
+    FnvGroupFunction fnv;
+};
+
+// SSE4.2 has no 32 bit lane multiply, and emulating it loses to hashing one key at a time, so the vector kernels
+// start at AVX2. They are compiled into every x86 build and picked at runtime.
+#ifdef CPPUTILS_HASH_DISPATCH
+// Stands in for words past the end of a key, so that building lanes stays branch free
+alignas(4) inline constexpr uint8_t zeroWord[4] = {};
+
+namespace avx2 {
+CPPUTILS_HASH_TARGET_REGION("avx2")
+
+struct Simd {
+    using V = __m256i;
+    static constexpr size_t Lanes = 8;
+
+    static void store(void* data, V value) { _mm256_storeu_si256(static_cast<V*>(data), value); }
+    static V set(uint32_t value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+    template <typename F> static V make(F&& lane) {
+        return _mm256_set_epi32(lane(7), lane(6), lane(5), lane(4), lane(3), lane(2), lane(1), lane(0));
+    }
+
+    static V bitAnd(V lhs, V rhs) { return _mm256_and_si256(lhs, rhs); }
+    static V bitOr(V lhs, V rhs) { return _mm256_or_si256(lhs, rhs); }
+    static V bitXor(V lhs, V rhs) { return _mm256_xor_si256(lhs, rhs); }
+    static V select(V mask, V lhs, V rhs) { return _mm256_blendv_epi8(lhs, rhs, mask); }
+
+    static V add(V lhs, V rhs) { return _mm256_add_epi32(lhs, rhs); }
+    static V mul(V lhs, V rhs) { return _mm256_mullo_epi32(lhs, rhs); }
+    template <int Count> static V shl(V value) { return _mm256_slli_epi32(value, Count); }
+    template <int Count> static V shr(V value) { return _mm256_srli_epi32(value, Count); }
+    // Signed compare, lengths are limited to 2^31 - 1
+    static V less(V lhs, V rhs) { return _mm256_cmpgt_epi32(rhs, lhs); }
+};
+
+#include "batch_kernels.h"
+
+CPPUTILS_HASH_TARGET_REGION_END
+} // namespace avx2
+
+namespace avx512 {
+CPPUTILS_HASH_TARGET_REGION("avx512f")
+
+struct Simd {
+    using V = __m512i;
+    static constexpr size_t Lanes = 16;
+
+    static void store(void* data, V value) { _mm512_storeu_si512(data, value); }
+    static V set(uint32_t value) { return _mm512_set1_epi32(static_cast<int>(value)); }
+    template <typename F> static V make(F&& lane) {
+        return _mm512_set_epi32(lane(15), lane(14), lane(13), lane(12), lane(11), lane(10), lane(9), lane(8), lane(7),
+                                lane(6), lane(5), lane(4), lane(3), lane(2), lane(1), lane(0));
+    }
+
+    static V bitAnd(V lhs, V rhs) { return _mm512_and_si512(lhs, rhs); }
+    static V bitOr(V lhs, V rhs) { return _mm512_or_si512(lhs, rhs); }
+    static V bitXor(V lhs, V rhs) { return _mm512_xor_si512(lhs, rhs); }
+    static V select(V mask, V lhs, V rhs) { return _mm512_ternarylogic_epi32(mask, rhs, lhs, 0xca); }
+
+    static V add(V lhs, V rhs) { return _mm512_add_epi32(lhs, rhs); }
+    static V mul(V lhs, V rhs) { return _mm512_mullo_epi32(lhs, rhs); }
+    // The zero masked forms, GCC 12 warns about the undefined pass through value of the plain ones
+    template <int Count> static V shl(V value) { return _mm512_maskz_slli_epi32(0xffff, value, Count); }
+    template <int Count> static V shr(V value) { return _mm512_maskz_srli_epi32(0xffff, value, Count); }
+    static V less(V lhs, V rhs) { return _mm512_maskz_set1_epi32(_mm512_cmplt_epu32_mask(lhs, rhs), -1); }
+};
+
+#include "batch_kernels.h"
+
+CPPUTILS_HASH_TARGET_REGION_END
+} // namespace avx512
+#endif
+
+inline GroupKernels selectGroupKernels(IsaLevel level = isaLevel()) {
+    static constexpr Kernel<GroupKernels> Kernels[] = {
+#ifdef CPPUTILS_HASH_DISPATCH
+        {IsaLevel::Avx512, {avx512::Simd::Lanes, &avx512::murmurGroup, &avx512::fnvGroup}},
+        {IsaLevel::Avx2, {avx2::Simd::Lanes, &avx2::murmurGroup, &avx2::fnvGroup}},
+#endif
+        {IsaLevel::Scalar, {1, nullptr, nullptr}},
+    };
+    return selectKernel(Kernels, level);
+}
+
+inline const GroupKernels& groupKernels() {
+    static const GroupKernels kernels = selectGroupKernels();
+    return kernels;
+}
+
+inline std::string_view keyBytes(const std::string_view& key) {
+    return key;
+}
+
+template <typename TKey> std::string_view keyBytes(const TKey& key) {
+    return {reinterpret_cast<const char*>(&key), sizeof(TKey)};
+}
+
+// Hashes groups of lanes keys with groupKernel where that pays off, and everything else one key at a time
+template <typename TKey, typename TOut, typename TGroupKernel, typename TSingle>
+void forEachGroup(std::span<const TKey> keys, std::span<TOut> hashes, size_t lanes, TGroupKernel&& groupKernel,
+                  TSingle&& single) {
+    assert(hashes.size() >= keys.size());
+    assert(lanes <= MaxLanes);
+
+    constexpr size_t MaxLength = 0x7fffffff;
+
+    size_t i = 0;
+    if (lanes > 1) {
+        for (; i + lanes <= keys.size(); i += lanes) {
+            Group group;
+            size_t total = 0;
+            bool fits = true;
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                const std::string_view bytes = keyBytes(keys[i + lane]);
+                total += bytes.size();
+                fits = fits && bytes.size() <= MaxLength;
+                group.data[lane] = reinterpret_cast<const uint8_t*>(bytes.data());
+                group.length[lane] = static_cast<uint32_t>(bytes.size());
+            }
+
+            if (fits && total >= MinimumSimdLength * lanes) {
+                groupKernel(group, hashes.data() + i);
+            } else {
+                for (size_t lane = 0; lane < lanes; ++lane) {
+                    hashes[i + lane] = single(keyBytes(keys[i + lane]));
+                }
+            }
+        }
+    }
+
+    for (; i < keys.size(); ++i) {
+        hashes[i] = single(keyBytes(keys[i]));
+    }
+}
+
+template <typename TKey>
+concept FixedWidthKey = std::is_trivially_copyable_v<TKey> && std::has_unique_object_representations_v<TKey> &&
+                        !std::same_as<TKey, std::string_view>;
+
+template <typename TKey>
+void murmurHash3Batch(std::span<const TKey> keys, std::span<uint32_t> hashes, uint32_t seed,
+                      const GroupKernels& kernels = groupKernels()) {
+    const auto single = [seed](std::string_view bytes) { return murmurHash3(bytes, seed); };
+    const auto group = [&](const Group& group, uint32_t* out) { kernels.murmur(group, seed, out); };
+    forEachGroup(keys, hashes, kernels.lanes, group, single);
+}
+
+template <typename T, typename TKey>
+void fnv1aBatch(std::span<const TKey> keys, std::span<T> hashes, const GroupKernels& kernels = groupKernels()) {
+    const auto single = [](std::string_view bytes) { return fnv1a<T>(bytes); };
+
+    // Without a 64 bit lane multiply the emulated one is slower than the scalar chain
+    const size_t lanes = std::is_same_v<T, uint32_t> ? kernels.lanes : 1;
+    const auto group = [&](const Group& group, T* out) {
+        if constexpr (std::is_same_v<T, uint32_t>) {
+            kernels.fnv(group, out);
+        }
+    };
+    forEachGroup(keys, hashes, lanes, group, single);
+}
+
+} // namespace batch
+} // namespace detail
+
+// Hashes every key with murmurHash3, several keys at a time in SIMD lanes where that is faster.
+// hashes must have room for at least keys.size() values.
+inline void murmurHash3Batch(std::span<const std::string_view> keys, std::span<uint32_t> hashes,
+                             uint32_t seed = 0) {
+    detail::batch::murmurHash3Batch(keys, hashes, seed);
+}
+
+// Hashes the object representation of every key, matching murmurHash3 over the key's bytes
+template <detail::batch::FixedWidthKey TKey>
+void murmurHash3Batch(std::span<const TKey> keys, std::span<uint32_t> hashes, uint32_t seed = 0) {
+    detail::batch::murmurHash3Batch(keys, hashes, seed);
+}
+
+// Hashes every key with fnv1a, several keys at a time in SIMD lanes where that is faster.
+// hashes must have room for at least keys.size() values.
+template <typename T> void fnv1aBatch(std::span<const std::string_view> keys, std::span<T> hashes) {
+    detail::batch::fnv1aBatch(keys, hashes);
+}
+
+// Hashes the object representation of every key, matching fnv1a over the key's bytes
+template <typename T, detail::batch::FixedWidthKey TKey>
+void fnv1aBatch(std::span<const TKey> keys, std::span<T> hashes) {
+    detail::batch::fnv1aBatch(keys, hashes);
+}
+
+} // namespace hash
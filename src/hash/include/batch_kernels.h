@@ -0,0 +1,110 @@
+// Generic batch kernels, written against the Simd operations of the enclosing namespace. batch.h includes this file
+// once per instruction set, inside that instruction set's namespace and target region, so it has no include guard and
+// must not include anything itself.
+
+inline Simd::V laneLengths(const Group& group) {
+    return Simd::make([&](size_t lane) { return static_cast<int>(group.length[lane]); });
+}
+
+// The 32 bit word at offset in each key of the group, zero for keys that end before it
+inline Simd::V loadWords(const Group& group, size_t offset) {
+    return Simd::make([&](size_t lane) {
+        const uint8_t* data = offset + 4 <= group.length[lane] ? group.data[lane] + offset : zeroWord;
+        return static_cast<int>(detail::load<uint32_t>(data));
+    });
+}
+
+// The bytes after the last whole 32 bit word in each key of the group
+inline Simd::V loadTails(const Group& group) {
+    return Simd::make([&](size_t lane) {
+        const uint32_t offset = group.length[lane] & ~3u;
+        return static_cast<int>(loadPartial<uint32_t>(group.data[lane] + offset, group.length[lane] - offset));
+    });
+}
+
+template <int Count> Simd::V rotl(Simd::V value) {
+    return Simd::bitOr(Simd::shl<Count>(value), Simd::shr<32 - Count>(value));
+}
+
+inline Simd::V murmurMixBlock(Simd::V block) {
+    using Constants = MurmurConstants<uint32_t>;
+
+    block = Simd::mul(block, Simd::set(Constants::Constant1));
+    block = rotl<Constants::Rotate1>(block);
+    return Simd::mul(block, Simd::set(Constants::Constant2));
+}
+
+inline Simd::V murmurFmix(Simd::V hash) {
+    using Constants = MurmurConstants<uint32_t>;
+
+    hash = Simd::bitXor(hash, Simd::shr<Constants::MixShiftA>(hash));
+    hash = Simd::mul(hash, Simd::set(Constants::MixConstantA));
+    hash = Simd::bitXor(hash, Simd::shr<Constants::MixShiftB>(hash));
+    hash = Simd::mul(hash, Simd::set(Constants::MixConstantB));
+    return Simd::bitXor(hash, Simd::shr<Constants::MixShiftC>(hash));
+}
+
+inline void murmurGroup(const Group& group, uint32_t seed, uint32_t* out) {
+    using V = Simd::V;
+    using Constants = MurmurConstants<uint32_t>;
+
+    uint32_t maxBlocks = 0;
+    for (size_t lane = 0; lane < Simd::Lanes; ++lane) {
+        maxBlocks = std::max(maxBlocks, group.length[lane] / 4);
+    }
+
+    const V length = laneLengths(group);
+    const V blockCount = Simd::shr<2>(length);
+    V hash = Simd::set(seed);
+
+    for (uint32_t block = 0; block < maxBlocks; ++block) {
+        V mixed = Simd::bitXor(hash, murmurMixBlock(loadWords(group, block * 4)));
+        mixed = rotl<Constants::Rotate2>(mixed);
+        mixed = Simd::add(Simd::add(Simd::shl<2>(mixed), mixed), Simd::set(Constants::Constant3));
+
+        hash = Simd::select(Simd::less(Simd::set(block), blockCount), hash, mixed);
+    }
+
+    const V hasTail = Simd::less(Simd::set(0), Simd::bitAnd(length, Simd::set(3)));
+    hash = Simd::bitXor(hash, Simd::bitAnd(hasTail, murmurMixBlock(loadTails(group))));
+    hash = Simd::bitXor(hash, length);
+
+    Simd::store(out, murmurFmix(hash));
+}
+
+// Mixes one byte of the word into the hash, in the lanes where mask is set
+template <int Byte> Simd::V fnvByte(Simd::V hash, Simd::V word, Simd::V mask) {
+    const Simd::V byte = Simd::bitAnd(Simd::shr<Byte * 8>(word), Simd::set(0xff));
+    const Simd::V next = Simd::mul(Simd::bitXor(hash, byte), Simd::set(Fnv1Constants<uint32_t>::Prime));
+    return Simd::select(mask, hash, next);
+}
+
+inline void fnvGroup(const Group& group, uint32_t* out) {
+    using V = Simd::V;
+
+    uint32_t maxWords = 0;
+    for (size_t lane = 0; lane < Simd::Lanes; ++lane) {
+        maxWords = std::max(maxWords, group.length[lane] / 4);
+    }
+
+    const V length = laneLengths(group);
+    const V wordCount = Simd::shr<2>(length);
+    V hash = Simd::set(Fnv1Constants<uint32_t>::Offset);
+
+    for (uint32_t word = 0; word < maxWords; ++word) {
+        const V active = Simd::less(Simd::set(word), wordCount);
+        const V bytes = loadWords(group, word * 4);
+        hash = fnvByte<0>(hash, bytes, active);
+        hash = fnvByte<1>(hash, bytes, active);
+        hash = fnvByte<2>(hash, bytes, active);
+        hash = fnvByte<3>(hash, bytes, active);
+    }
+
+    const V tailLength = Simd::bitAnd(length, Simd::set(3));
+    const V tail = loadTails(group);
+    hash = fnvByte<0>(hash, tail, Simd::less(Simd::set(0), tailLength));
+    hash = fnvByte<1>(hash, tail, Simd::less(Simd::set(1), tailLength));
+    hash = fnvByte<2>(hash, tail, Simd::less(Simd::set(2), tailLength));
+
+    Simd::store(out, hash);
+}
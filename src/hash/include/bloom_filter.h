@@ -0,0 +1,361 @@
+#pragma once
+
+#include "dispatch.h"
+#include "hash_util.h"
+#include "murmur.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <stdint.h>
+#include <string_view>
+#include <utility>
+
+#if defined(CPPUTILS_HASH_DISPATCH)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace hash {
+namespace detail {
+namespace bloom {
+
+// "BLOM" and the format version
+constexpr uint64_t Magic = 0x4d4f4c4200000001ull;
+
+// One cache line per block
+constexpr size_t BlockWords = 8;
+constexpr size_t BlockBytes = BlockWords * sizeof(uint64_t);
+constexpr size_t MaxHashCount = 16;
+
+// Header words, padded to a full block so the blocks stay cache line aligned in the serialized form
+constexpr size_t HeaderMagic = 0;
+constexpr size_t HeaderBlockCount = 1;
+constexpr size_t HeaderHashCount = 2;
+constexpr size_t HeaderSeed = 3;
+constexpr size_t HeaderSize = BlockWords;
+
+using BlockMask = std::array<uint64_t, BlockWords>;
+
+struct Probe {
+    size_t block;
+    BlockMask mask;
+};
+
+// Kirsch-Mitzenmacher: the i-th probe is derived from h2 + i * h1, so one 128 bit hash gives every probe. Taking 9 bits
+// of the progression directly makes the bit patterns of keys overlap far more than random ones would, so each position
+// is remixed with a multiply first. The block comes from the top bits of h1, the step uses it rotated.
+inline Probe probe(std::string_view key, uint64_t seed, uint64_t blockCount, size_t hashCount) {
+    const auto [h1, h2] = detail::murmurHash3x64(key.begin(), key.end(), seed);
+    const uint64_t step = detail::rotl(h1, 32) | 1;
+
+    Probe result{static_cast<size_t>(fastRange(h1, blockCount)), {}};
+    uint64_t position = h2;
+    for (size_t i = 0; i < hashCount; ++i, position += step) {
+        const uint64_t bit = ((position ^ (position >> 32)) * 0x9e3779b97f4a7c15ull) >> 55;
+        result.mask[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    return result;
+}
+
+using TestBlockFunction = bool (*)(const uint64_t* block, const BlockMask& mask);
+using SetBlockFunction = void (*)(uint64_t* block, const BlockMask& mask);
+
+struct BlockKernels {
+    TestBlockFunction test;
+    SetBlockFunction set;
+};
+
+inline bool testBlockScalar(const uint64_t* block, const BlockMask& mask) {
+    uint64_t missing = 0;
+    for (size_t i = 0; i < BlockWords; ++i) {
+        missing |= mask[i] & ~block[i];
+    }
+    return missing == 0;
+}
+
+inline void setBlockScalar(uint64_t* block, const BlockMask& mask) {
+    for (size_t i = 0; i < BlockWords; ++i) {
+        block[i] |= mask[i];
+    }
+}
+
+// One block is two AVX2 or four SSE2 vectors
+#if defined(__SSE2__) || defined(_M_X64)
+namespace sse2 {
+inline bool testBlock(const uint64_t* block, const BlockMask& mask) {
+    const __m128i* lanes = reinterpret_cast<const __m128i*>(block);
+    const __m128i* bits = reinterpret_cast<const __m128i*>(mask.data());
+    __m128i missing = _mm_setzero_si128();
+    for (size_t i = 0; i < BlockWords / 2; ++i) {
+        missing = _mm_or_si128(missing, _mm_andnot_si128(_mm_loadu_si128(lanes + i), _mm_loadu_si128(bits + i)));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xffff;
+}
+
+inline void setBlock(uint64_t* block, const BlockMask& mask) {
+    __m128i* lanes = reinterpret_cast<__m128i*>(block);
+    const __m128i* bits = reinterpret_cast<const __m128i*>(mask.data());
+    for (size_t i = 0; i < BlockWords / 2; ++i) {
+        _mm_storeu_si128(lanes + i, _mm_or_si128(_mm_loadu_si128(lanes + i), _mm_loadu_si128(bits + i)));
+    }
+}
+} // namespace sse2
+#endif
+
+#ifdef CPPUTILS_HASH_DISPATCH
+namespace avx2 {
+CPPUTILS_HASH_TARGET_REGION("avx2")
+
+inline bool testBlock(const uint64_t* block, const BlockMask& mask) {
+    const __m256i* lanes = reinterpret_cast<const __m256i*>(block);
+    const __m256i* bits = reinterpret_cast<const __m256i*>(mask.data());
+    return _mm256_testc_si256(_mm256_loadu_si256(lanes), _mm256_loadu_si256(bits)) &&
+           _mm256_testc_si256(_mm256_loadu_si256(lanes + 1), _mm256_loadu_si256(bits + 1));
+}
+
+inline void setBlock(uint64_t* block, const BlockMask& mask) {
+    __m256i* lanes = reinterpret_cast<__m256i*>(block);
+    const __m256i* bits = reinterpret_cast<const __m256i*>(mask.data());
+    for (size_t i = 0; i < 2; ++i) {
+        _mm256_storeu_si256(lanes + i, _mm256_or_si256(_mm256_loadu_si256(lanes + i), _mm256_loadu_si256(bits + i)));
+    }
+}
+
+CPPUTILS_HASH_TARGET_REGION_END
+} // namespace avx2
+#endif
+
+inline BlockKernels selectBlockKernels(IsaLevel level = isaLevel()) {
+    static constexpr Kernel<BlockKernels> Kernels[] = {
+#ifdef CPPUTILS_HASH_DISPATCH
+        {IsaLevel::Avx2, {&avx2::testBlock, &avx2::setBlock}},
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+        {IsaLevel::Scalar, {&sse2::testBlock, &sse2::setBlock}},
+#else
+        {IsaLevel::Scalar, {&testBlockScalar, &setBlockScalar}},
+#endif
+    };
+    return selectKernel(Kernels, level);
+}
+
+inline const BlockKernels& blockKernels() {
+    static const BlockKernels kernels = selectBlockKernels();
+    return kernels;
+}
+
+struct AlignedDelete {
+    void operator()(uint64_t* words) const { ::operator delete(words, std::align_val_t{BlockBytes}); }
+};
+
+using AlignedWords = std::unique_ptr<uint64_t[], AlignedDelete>;
+
+inline AlignedWords allocateWords(size_t count) {
+    auto* words = static_cast<uint64_t*>(::operator new(count * sizeof(uint64_t), std::align_val_t{BlockBytes}));
+    std::fill_n(words, count, 0);
+    return AlignedWords(words);
+}
+
+} // namespace bloom
+} // namespace detail
+
+// Read only view of a serialized Bloom filter, for example straight from a memory mapped file. The words have to stay
+// alive and unchanged while the view is in use, and should be 64 byte aligned to keep each probe in one cache line.
+class BloomFilterView {
+  public:
+    BloomFilterView() = default;
+
+    explicit BloomFilterView(std::span<const uint64_t> words) {
+        using namespace detail::bloom;
+
+        if (words.size() < HeaderSize || words[HeaderMagic] != Magic) {
+            throw std::invalid_argument("Not a Bloom filter blob");
+        }
+
+        blockCount = words[HeaderBlockCount];
+        hashCount = static_cast<size_t>(words[HeaderHashCount]);
+        seed = words[HeaderSeed];
+
+        // The block count comes from the blob, bound it before the multiplication can wrap
+        if (blockCount == 0 || hashCount == 0 || hashCount > MaxHashCount ||
+            blockCount > (words.size() - HeaderSize) / BlockWords ||
+            words.size() != HeaderSize + blockCount * BlockWords) {
+            throw std::invalid_argument("Truncated Bloom filter blob");
+        }
+
+        blocks = words.data() + HeaderSize;
+    }
+
+    // False means the key was never inserted, true means it probably was
+    bool contains(std::string_view key) const {
+        if (blocks == nullptr) {
+            return false;
+        }
+        const detail::bloom::Probe probe = detail::bloom::probe(key, seed, blockCount, hashCount);
+        return detail::bloom::blockKernels().test(blocks + probe.block * detail::bloom::BlockWords, probe.mask);
+    }
+
+  private:
+    uint64_t blockCount = 0;
+    size_t hashCount = 0;
+    uint64_t seed = 0;
+    const uint64_t* blocks = nullptr;
+};
+
+// Blocked Bloom filter: every key sets and tests its bits within a single 64 byte block, so a lookup costs one cache
+// miss no matter how many hash functions are used. The price is a slightly higher false positive rate than a classic
+// filter of the same size.
+class BloomFilter {
+  public:
+    BloomFilter() = default;
+
+    // Sized for the expected number of keys at the requested false positive rate
+    BloomFilter(size_t expectedKeys, double falsePositiveRate, uint64_t seed = 0) {
+        using namespace detail::bloom;
+
+        if (!(falsePositiveRate > 0 && falsePositiveRate < 1)) {
+            throw std::invalid_argument("Bloom filter false positive rate must be between 0 and 1");
+        }
+
+        const double keys = static_cast<double>(std::max<size_t>(expectedKeys, 1));
+        const double ln2 = std::log(2.0);
+        const double bits = std::ceil(-keys * std::log(falsePositiveRate) / (ln2 * ln2));
+        const double hashes = std::round(bits / keys * ln2);
+
+        const size_t hashCount = static_cast<size_t>(std::clamp(hashes, 1.0, static_cast<double>(MaxHashCount)));
+
+        // Start from the size of a classic filter and grow until the uneven block loads are paid for
+        size_t blockCount = std::max<size_t>(1, static_cast<size_t>(std::ceil(bits / (BlockBytes * 8))));
+        while (falsePositiveRate < estimateFalsePositiveRate(keys / static_cast<double>(blockCount), hashCount)) {
+            blockCount += std::max<size_t>(1, blockCount / 16);
+        }
+        allocate(blockCount, hashCount, seed);
+    }
+
+    // Copies a blob written from words() back into a filter that can take more keys
+    explicit BloomFilter(std::span<const uint64_t> words) {
+        // Validates the blob
+        (void)BloomFilterView(words);
+
+        count = words.size();
+        storage = detail::bloom::allocateWords(count);
+        std::copy(words.begin(), words.end(), storage.get());
+        cachedView = BloomFilterView(this->words());
+    }
+
+    BloomFilter(const BloomFilter& other) : count(other.count) {
+        if (other.storage) {
+            storage = detail::bloom::allocateWords(count);
+            std::copy_n(other.storage.get(), count, storage.get());
+            cachedView = BloomFilterView(words());
+        }
+    }
+    // The view points into the storage, which moves along with it
+    BloomFilter(BloomFilter&& other) noexcept
+        : storage(std::move(other.storage)), count(std::exchange(other.count, 0)),
+          cachedView(std::exchange(other.cachedView, {})) {}
+
+    BloomFilter& operator=(const BloomFilter& other) {
+        if (this != &other) {
+            *this = BloomFilter(other);
+        }
+        return *this;
+    }
+    BloomFilter& operator=(BloomFilter&& other) noexcept {
+        storage = std::move(other.storage);
+        count = std::exchange(other.count, 0);
+        cachedView = std::exchange(other.cachedView, {});
+        return *this;
+    }
+
+    void insert(std::string_view key) {
+        const detail::bloom::Probe probe = probeKey(key);
+        detail::bloom::blockKernels().set(block(probe), probe.mask);
+    }
+
+    // Safe to call from several threads at once. Lookups must not overlap with it.
+    void insertConcurrent(std::string_view key) {
+        const detail::bloom::Probe probe = probeKey(key);
+        uint64_t* words = block(probe);
+        for (size_t i = 0; i < detail::bloom::BlockWords; ++i) {
+            if (probe.mask[i] != 0) {
+                std::atomic_ref<uint64_t>(words[i]).fetch_or(probe.mask[i], std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool contains(std::string_view key) const { return cachedView.contains(key); }
+
+    void clear() {
+        if (storage) {
+            std::fill(storage.get() + detail::bloom::HeaderSize, storage.get() + count, 0);
+        }
+    }
+
+    size_t blockCount() const { return storage ? static_cast<size_t>(storage[detail::bloom::HeaderBlockCount]) : 0; }
+    size_t hashCount() const { return storage ? static_cast<size_t>(storage[detail::bloom::HeaderHashCount]) : 0; }
+
+    // Serialized form, the header is one block long so the blocks keep their alignment when the blob is mapped
+    std::span<const uint64_t> words() const { return {storage.get(), count}; }
+
+    BloomFilterView view() const { return cachedView; }
+
+  private:
+    // Block loads are Poisson distributed, weight the false positive rate of a block with i keys accordingly
+    static double estimateFalsePositiveRate(double keysPerBlock, size_t hashCount) {
+        constexpr double BlockBits = detail::bloom::BlockBytes * 8;
+        const double k = static_cast<double>(hashCount);
+        const size_t limit = static_cast<size_t>(keysPerBlock + 10 * std::sqrt(keysPerBlock) + 10);
+
+        double weight = std::exp(-keysPerBlock);
+        double rate = 0;
+        for (size_t i = 0; i <= limit; ++i) {
+            if (i > 0) {
+                weight *= keysPerBlock / static_cast<double>(i);
+            }
+            rate += weight * std::pow(1 - std::pow(1 - 1 / BlockBits, static_cast<double>(i) * k), k);
+        }
+        return rate;
+    }
+
+    void allocate(size_t blockCount, size_t hashCount, uint64_t seed) {
+        using namespace detail::bloom;
+
+        count = HeaderSize + blockCount * BlockWords;
+        storage = allocateWords(count);
+        storage[HeaderMagic] = Magic;
+        storage[HeaderBlockCount] = blockCount;
+        storage[HeaderHashCount] = hashCount;
+        storage[HeaderSeed] = seed;
+        cachedView = BloomFilterView(words());
+    }
+
+    detail::bloom::Probe probeKey(std::string_view key) const {
+        using namespace detail::bloom;
+
+        if (!storage) {
+            throw std::logic_error("Bloom filter has no storage");
+        }
+        return probe(key, storage[HeaderSeed], storage[HeaderBlockCount],
+                     static_cast<size_t>(storage[HeaderHashCount]));
+    }
+
+    uint64_t* block(const detail::bloom::Probe& probe) {
+        return storage.get() + detail::bloom::HeaderSize + probe.block * detail::bloom::BlockWords;
+    }
+
+  private:
+    detail::bloom::AlignedWords storage;
+    size_t count = 0;
+    // Validated once whenever the storage changes, so lookups skip the header checks
+    BloomFilterView cachedView;
+};
+
+} // namespace hash
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "hash_util.h"
+#include "murmur.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#if __has_include("mapped_file.h")
+#include "mapped_file.h"
+#endif
+
+namespace hash {
+namespace detail {
+namespace cdc {
+
+constexpr uint64_t splitMix64(uint64_t& state) {
+    uint64_t value = (state += 0x9e3779b97f4a7c15ull);
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+constexpr std::array<uint64_t, 256> makeGearTable() {
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0x6765617268617368ull;
+    for (uint64_t& value : table) {
+        value = splitMix64(state);
+    }
+    return table;
+}
+
+inline constexpr std::array<uint64_t, 256> GearTable = makeGearTable();
+
+// Cut when the top bits of the hash are zero, the top bits are the ones that depend on the full 64 byte window
+constexpr uint64_t topMask(unsigned bits) { return bits == 0 ? 0 : ~uint64_t(0) << (64 - bits); }
+
+// Advances position until the masked hash is zero, true if that happened before end. The hash is a chain of single
+// cycle steps, so the loop is unrolled to keep the bookkeeping off the critical path.
+inline bool scan(const uint8_t* data, size_t& position, size_t end, uint64_t& hash, uint64_t mask) {
+    uint64_t value = hash;
+    size_t i = position;
+
+    const auto step = [&](size_t offset) {
+        value = (value << 1) + GearTable[data[i + offset]];
+        return (value & mask) == 0;
+    };
+    const auto done = [&](size_t offset, bool found) {
+        position = i + offset;
+        hash = value;
+        return found;
+    };
+
+    for (; i + 4 <= end; i += 4) {
+        if (step(0)) {
+            return done(0, true);
+        }
+        if (step(1)) {
+            return done(1, true);
+        }
+        if (step(2)) {
+            return done(2, true);
+        }
+        if (step(3)) {
+            return done(3, true);
+        }
+    }
+    for (; i < end; ++i) {
+        if (step(0)) {
+            return done(0, true);
+        }
+    }
+    return done(0, false);
+}
+
+} // namespace cdc
+} // namespace detail
+
+// Gear rolling hash: every byte shifts the state left by one, so a byte drops out of the hash 64 bytes later
+class GearHash {
+  public:
+    constexpr void update(uint8_t byte) { hash = (hash << 1) + detail::cdc::GearTable[byte]; }
+
+    constexpr uint64_t value() const { return hash; }
+
+    constexpr void reset() { hash = 0; }
+
+  private:
+    uint64_t hash = 0;
+};
+
+struct ChunkerOptions {
+    // Chunks are never smaller than minSize unless the input ends, and never larger than maxSize
+    size_t minSize = 2 * 1024;
+    size_t averageSize = 8 * 1024;
+    size_t maxSize = 64 * 1024;
+    // Seed of the chunk fingerprints
+    uint64_t seed = 0;
+};
+
+// 128 bit MurmurHash3 x64 of the chunk, in the same lane order as murmurHash3_128
+struct ChunkFingerprint {
+    uint64_t low;
+    uint64_t high;
+
+    friend constexpr bool operator==(const ChunkFingerprint&, const ChunkFingerprint&) = default;
+};
+
+struct Chunk {
+    // Position of the chunk in the whole stream
+    uint64_t offset;
+    // Only valid during the callback
+    std::span<const uint8_t> data;
+    ChunkFingerprint fingerprint;
+};
+
+// Content defined chunking in the style of FastCDC. Boundaries are chosen by a Gear rolling hash, so inserting or
+// removing bytes only changes the chunks around the edit and the rest still deduplicates. The first minSize bytes of
+// every chunk are skipped without hashing, and normalized chunking uses a stricter mask before averageSize and a
+// looser one after it, which narrows the size distribution around the average.
+//
+// Data can be fed in pieces of any size. Chunks that lie within one piece are reported without copying, only a chunk
+// spanning several update calls and the tail reported by finish are assembled in an internal buffer.
+class ContentChunker {
+  public:
+    explicit ContentChunker(const ChunkerOptions& options = {}) : options(options) {
+        if (options.minSize == 0 || options.minSize > options.averageSize || options.averageSize > options.maxSize) {
+            throw std::invalid_argument("Chunk sizes must satisfy 0 < minSize <= averageSize <= maxSize");
+        }
+
+        const unsigned bits = static_cast<unsigned>(std::bit_width(options.averageSize) - 1);
+        strictMask = detail::cdc::topMask(std::min(bits + 2, 63u));
+        looseMask = detail::cdc::topMask(bits > 2 ? bits - 2 : 0);
+    }
+
+    // Calls onChunk(const Chunk&) for every chunk that ends within the data seen so far
+    template <typename F> void update(std::span<const uint8_t> data, F&& onChunk) {
+        while (!data.empty() && !pending.empty()) {
+            const size_t take = std::min(data.size(), options.maxSize - pending.size());
+            pending.insert(pending.end(), data.begin(), data.begin() + static_cast<std::ptrdiff_t>(take));
+            data = data.subspan(take);
+
+            const size_t cut = findCut(pending.data(), pending.size());
+            if (cut == 0) {
+                return;
+            }
+
+            emit(std::span<const uint8_t>(pending.data(), cut), onChunk);
+
+            // Bytes after the cut came from this call, so go back to chunking them in place
+            const size_t unused = pending.size() - cut;
+            pending.clear();
+            data = std::span<const uint8_t>(data.data() - unused, data.size() + unused);
+        }
+
+        while (!data.empty()) {
+            const size_t cut = findCut(data.data(), data.size());
+            if (cut == 0) {
+                pending.assign(data.begin(), data.end());
+                return;
+            }
+
+            emit(data.first(cut), onChunk);
+            data = data.subspan(cut);
+        }
+    }
+
+    // Reports the remaining data as the last chunk
+    template <typename F> void finish(F&& onChunk) {
+        if (!pending.empty()) {
+            emit(std::span<const uint8_t>(pending), onChunk);
+            pending.clear();
+        }
+        scanned = 0;
+        rolling = 0;
+    }
+
+  private:
+    // Length of the next chunk, or zero when the data ends before a boundary. Picks up the scan where the previous
+    // call on the same chunk stopped.
+    size_t findCut(const uint8_t* data, size_t length) {
+        const size_t end = std::min(length, options.maxSize);
+        const size_t normal = std::min(end, options.averageSize);
+
+        size_t i = std::max(scanned, options.minSize);
+        uint64_t hash = rolling;
+
+        bool found = detail::cdc::scan(data, i, normal, hash, strictMask);
+        if (!found) {
+            found = detail::cdc::scan(data, i, end, hash, looseMask);
+        }
+
+        if (found || end == options.maxSize) {
+            scanned = 0;
+            rolling = 0;
+            return found ? i + 1 : end;
+        }
+
+        scanned = i;
+        rolling = hash;
+        return 0;
+    }
+
+    template <typename F> void emit(std::span<const uint8_t> data, F& onChunk) {
+        const auto [low, high] = detail::murmurHash3x64(data.begin(), data.end(), options.seed);
+        onChunk(Chunk{offset, data, ChunkFingerprint{low, high}});
+        offset += data.size();
+    }
+
+  private:
+    ChunkerOptions options;
+    uint64_t strictMask;
+    uint64_t looseMask;
+    uint64_t offset = 0;
+    // Scan position and hash of a chunk that continues in the next update
+    size_t scanned = 0;
+    uint64_t rolling = 0;
+    std::vector<uint8_t> pending;
+};
+
+// Chunks a complete buffer
+template <typename F> void chunkBuffer(std::span<const uint8_t> data, const ChunkerOptions& options, F&& onChunk) {
+    ContentChunker chunker(options);
+    chunker.update(data, onChunk);
+    chunker.finish(onChunk);
+}
+
+#if __has_include("mapped_file.h")
+// Maps the file and chunks it in place, without reading it into a buffer first
+template <typename F> void chunkFile(const std::filesystem::path& path, const ChunkerOptions& options, F&& onChunk) {
+    const memory::MappedFile file(path);
+    chunkBuffer(file.bytes(), options, onChunk);
+}
+#endif
+
+} // namespace hash
@@ -0,0 +1,456 @@
+#pragma once
+
+#include "epoch.h"
+#include "flat_hash_map.h"
+#include "tagged_ptr.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <functional>
+#include <optional>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+namespace hash {
+namespace detail {
+namespace concurrent {
+
+struct NodeBase;
+
+// Link to the next node in the list. The tag holds a deletion mark in its lowest bit and a version in the others, which
+// is bumped by every successful exchange, so a link that was changed and changed back still fails a stale exchange.
+using Link = memory::TaggedPtr<NodeBase, 8, alignof(uint64_t)>;
+
+static_assert(std::is_trivially_copyable_v<Link> && sizeof(Link) == sizeof(void*));
+
+constexpr uintptr_t Marked = 1;
+constexpr uintptr_t VersionStep = 2;
+constexpr uintptr_t TagMask = (uintptr_t(1) << Link::tagBits) - 1;
+
+constexpr uintptr_t nextVersion(uintptr_t tag) { return ((tag & ~Marked) + VersionStep) & TagMask; }
+
+struct NodeBase {
+    explicit NodeBase(uint64_t order) : order(order) {}
+
+    // Position in split order, odd for entries and even for bucket sentinels
+    const uint64_t order;
+    std::atomic<Link> next{};
+};
+
+static_assert(alignof(NodeBase) >= alignof(uint64_t));
+
+template <typename K, typename V> struct Node : NodeBase {
+    template <typename TKey, typename... TArgs>
+    Node(uint64_t order, TKey&& key, TArgs&&... args)
+        : NodeBase(order), key(std::forward<TKey>(key)), value(std::forward<TArgs>(args)...) {}
+
+    const K key;
+    const V value;
+};
+
+constexpr uint64_t reverseBits(uint64_t value) {
+    value = ((value >> 1) & 0x5555555555555555) | ((value & 0x5555555555555555) << 1);
+    value = ((value >> 2) & 0x3333333333333333) | ((value & 0x3333333333333333) << 2);
+    value = ((value >> 4) & 0x0f0f0f0f0f0f0f0f) | ((value & 0x0f0f0f0f0f0f0f0f) << 4);
+    value = ((value >> 8) & 0x00ff00ff00ff00ff) | ((value & 0x00ff00ff00ff00ff) << 8);
+    value = ((value >> 16) & 0x0000ffff0000ffff) | ((value & 0x0000ffff0000ffff) << 16);
+    return (value >> 32) | (value << 32);
+}
+
+// Entries sort by their bit reversed hash, so the entries of a bucket stay contiguous when the bucket is split
+constexpr uint64_t entryOrder(uint64_t hash) { return reverseBits(hash | (uint64_t(1) << 63)); }
+constexpr uint64_t sentinelOrder(size_t bucket) { return reverseBits(bucket); }
+
+// The bucket that was split to create this one
+constexpr size_t parentBucket(size_t bucket) { return bucket & ~std::bit_floor(bucket); }
+
+// Bucket slots live in segments that double in size and are never moved, segment 0 holds buckets 0 and 1 and segment
+// s > 0 holds buckets [2^s, 2^(s + 1))
+constexpr size_t MaxSegments = 64;
+
+constexpr size_t segmentIndex(size_t bucket) { return bucket < 2 ? 0 : std::bit_width(bucket) - 1; }
+constexpr size_t segmentBase(size_t segment) { return segment == 0 ? 0 : size_t(1) << segment; }
+constexpr size_t segmentSize(size_t segment) { return segment == 0 ? 2 : size_t(1) << segment; }
+
+// Threads take the counter stripes round robin, the first 16 threads never share one
+constexpr size_t CounterStripes = 16;
+
+inline size_t counterStripe() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t stripe = next.fetch_add(1, std::memory_order_relaxed) % CounterStripes;
+    return stripe;
+}
+
+} // namespace concurrent
+} // namespace detail
+
+// Lock-free hash map for tables shared between many threads, a split-ordered list in the style of Shalev and Shavit.
+// All entries are kept in one linked list sorted by their bit reversed hash, and the buckets are sentinel nodes in
+// that list. Growing only raises the bucket count, a new bucket is spliced into the list on its first update, so a
+// resize never moves entries and never stops other threads.
+//
+// Lookups take no locks, never write shared memory and never retry. Insertions and erasures exchange one or two links
+// and retry only when another thread changed the same links. Entries are immutable once inserted, so lookups hand out
+// copies or run a visitor, and erased entries are freed through memory::retire once no lookup can still reach them.
+template <typename K, typename V, typename THash = DefaultHasher, typename TEqual = std::equal_to<>>
+class ConcurrentHashMap {
+  private:
+    using Link = detail::concurrent::Link;
+    using NodeBase = detail::concurrent::NodeBase;
+    using Node = detail::concurrent::Node<K, V>;
+    using Slot = std::atomic<NodeBase*>;
+
+    static constexpr size_t MaxLoadFactor = 2;
+    static constexpr size_t GrowthCheckInterval = 16;
+    static constexpr size_t MaxBuckets = size_t(1) << 62;
+
+    static constexpr bool IsTransparent =
+        requires { typename THash::is_transparent; } && requires { typename TEqual::is_transparent; };
+
+    // Where a search stopped: the first node not before the key, and the link that points to it
+    struct Position {
+        std::atomic<Link>* previous;
+        Link expected;
+        NodeBase* current;
+    };
+
+    struct alignas(64) Counter {
+        std::atomic<ptrdiff_t> value{0};
+    };
+
+  public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = size_t;
+    using hasher = THash;
+    using key_equal = TEqual;
+
+    explicit ConcurrentHashMap(size_t buckets = 16)
+        : bucketMask(std::bit_ceil(std::clamp<size_t>(buckets, 2, MaxBuckets)) - 1) {
+        allocateSlot(0)->store(new NodeBase(detail::concurrent::sentinelOrder(0)), std::memory_order_release);
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    // No other thread may use the map any more, entries erased earlier are freed by the epoch collector
+    ~ConcurrentHashMap() {
+        for (NodeBase* node = slot(0)->load(std::memory_order_acquire); node != nullptr;) {
+            NodeBase* next = node->next.load(std::memory_order_relaxed).get();
+            if (node->order & 1) {
+                delete static_cast<Node*>(node);
+            } else {
+                delete node;
+            }
+            node = next;
+        }
+        for (std::atomic<Slot*>& segment : segments) {
+            delete[] segment.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Entries at the moment of the call, exact only while no other thread changes the map
+    size_t size() const {
+        ptrdiff_t count = 0;
+        for (const Counter& counter : counters) {
+            count += counter.value.load(std::memory_order_relaxed);
+        }
+        return count > 0 ? static_cast<size_t>(count) : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_t bucketCount() const { return bucketMask.load(std::memory_order_relaxed) + 1; }
+
+    std::optional<V> find(const K& key) const { return findValue(key); }
+
+    template <typename TKey>
+        requires(IsTransparent)
+    std::optional<V> find(const TKey& key) const {
+        return findValue(key);
+    }
+
+    bool contains(const K& key) const { return visit(key, [](const V&) {}); }
+
+    template <typename TKey>
+        requires(IsTransparent)
+    bool contains(const TKey& key) const {
+        return visit(key, [](const V&) {});
+    }
+
+    // Calls visitor with the value of the key without copying it, returns whether the key was found. The reference is
+    // only valid during the call.
+    template <typename TKey, typename F>
+        requires(std::same_as<TKey, K> || IsTransparent)
+    bool visit(const TKey& key, F&& visitor) const {
+        const memory::EpochGuard guard;
+        const Node* node = lookup(key);
+        if (node == nullptr) {
+            return false;
+        }
+        std::invoke(std::forward<F>(visitor), node->value);
+        return true;
+    }
+
+    // Calls visitor with every key and value present for the whole call. Entries inserted or erased concurrently may
+    // or may not be visited.
+    template <typename F> void forEach(F&& visitor) const {
+        const memory::EpochGuard guard;
+        for (const NodeBase* node = slot(0)->load(std::memory_order_acquire); node != nullptr;) {
+            const Link next = node->next.load(std::memory_order_acquire);
+            if ((node->order & 1) && !(next.tag() & detail::concurrent::Marked)) {
+                const Node* entry = static_cast<const Node*>(node);
+                std::invoke(visitor, entry->key, entry->value);
+            }
+            node = next.get();
+        }
+    }
+
+    // Constructs V(args...) unless the key is already present and returns whether it was inserted. The entry is only
+    // allocated once the key was not found.
+    template <typename TKey, typename... TArgs>
+        requires(std::same_as<std::remove_cvref_t<TKey>, K> || (IsTransparent && std::constructible_from<K, TKey>))
+    bool tryEmplace(TKey&& key, TArgs&&... args) {
+        const memory::EpochGuard guard;
+        const size_t hash = hashFunction(key);
+        const uint64_t order = detail::concurrent::entryOrder(hash);
+        NodeBase* head = bucketForUpdate(hash);
+
+        Node* node = nullptr;
+        Position position;
+        for (;;) {
+            const bool found = node == nullptr ? search(head, order, &key, position)
+                                               : search(head, order, &node->key, position);
+            if (found) {
+                delete node;
+                return false;
+            }
+            if (node == nullptr) {
+                node = new Node(order, std::forward<TKey>(key), std::forward<TArgs>(args)...);
+            }
+
+            node->next.store(Link(position.current), std::memory_order_relaxed);
+            const Link desired(node, detail::concurrent::nextVersion(position.expected.tag()));
+            if (position.previous->compare_exchange_strong(position.expected, desired, std::memory_order_release,
+                                                           std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        const ptrdiff_t count =
+            counters[detail::concurrent::counterStripe()].value.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (count % GrowthCheckInterval == 0) {
+            grow();
+        }
+        return true;
+    }
+
+    bool insert(const value_type& value) { return tryEmplace(value.first, value.second); }
+    bool insert(value_type&& value) { return tryEmplace(value.first, std::move(value.second)); }
+
+    size_t erase(const K& key) { return eraseKey(key); }
+
+    template <typename TKey>
+        requires(IsTransparent)
+    size_t erase(const TKey& key) {
+        return eraseKey(key);
+    }
+
+  private:
+    template <typename TKey> std::optional<V> findValue(const TKey& key) const {
+        std::optional<V> result;
+        visit(key, [&](const V& value) { result.emplace(value); });
+        return result;
+    }
+
+    // Read only walk from the nearest initialized bucket, skipping entries that are marked as erased
+    template <typename TKey> const Node* lookup(const TKey& key) const {
+        const size_t hash = hashFunction(key);
+        const uint64_t order = detail::concurrent::entryOrder(hash);
+
+        const NodeBase* node = bucketForLookup(hash)->next.load(std::memory_order_acquire).get();
+        while (node != nullptr && node->order <= order) {
+            const Link next = node->next.load(std::memory_order_acquire);
+            if (node->order == order && !(next.tag() & detail::concurrent::Marked) &&
+                equalFunction(static_cast<const Node*>(node)->key, key)) {
+                return static_cast<const Node*>(node);
+            }
+            node = next.get();
+        }
+        return nullptr;
+    }
+
+    // Finds the first node at or after order that is not before key, unlinking marked nodes on the way, and returns
+    // whether it holds the key. A null key searches for the bucket sentinel with that order.
+    template <typename TKey> bool search(NodeBase* head, uint64_t order, const TKey* key, Position& position) {
+        for (;;) {
+            std::atomic<Link>* previous = &head->next;
+            Link expected = previous->load(std::memory_order_acquire);
+            bool restart = false;
+
+            while (!restart) {
+                NodeBase* current = expected.get();
+                if (current == nullptr) {
+                    position = {previous, expected, nullptr};
+                    return false;
+                }
+
+                const Link next = current->next.load(std::memory_order_acquire);
+                if (next.tag() & detail::concurrent::Marked) {
+                    const Link replacement(next.get(), detail::concurrent::nextVersion(expected.tag()));
+                    if (!previous->compare_exchange_strong(expected, replacement, std::memory_order_acq_rel,
+                                                           std::memory_order_acquire)) {
+                        restart = true;
+                        continue;
+                    }
+                    memory::retire(static_cast<Node*>(current));
+                    expected = replacement;
+                    continue;
+                }
+
+                if (current->order >= order) {
+                    const bool match =
+                        current->order == order &&
+                        (key == nullptr || equalFunction(static_cast<const Node*>(current)->key, *key));
+                    if (current->order > order || match) {
+                        position = {previous, expected, current};
+                        return match;
+                    }
+                }
+
+                previous = &current->next;
+                expected = next;
+            }
+        }
+    }
+
+    template <typename TKey> size_t eraseKey(const TKey& key) {
+        const memory::EpochGuard guard;
+        const size_t hash = hashFunction(key);
+        const uint64_t order = detail::concurrent::entryOrder(hash);
+        NodeBase* head = bucketForUpdate(hash);
+
+        Position position;
+        for (;;) {
+            if (!search(head, order, &key, position)) {
+                return 0;
+            }
+
+            // Marking the node erases it logically and freezes its link, unlinking it is then only a clean up
+            NodeBase* current = position.current;
+            Link next = current->next.load(std::memory_order_acquire);
+            if (next.tag() & detail::concurrent::Marked) {
+                continue;
+            }
+            const Link marked(next.get(), detail::concurrent::nextVersion(next.tag()) | detail::concurrent::Marked);
+            if (!current->next.compare_exchange_strong(next, marked, std::memory_order_acq_rel,
+                                                       std::memory_order_relaxed)) {
+                continue;
+            }
+
+            const Link replacement(next.get(), detail::concurrent::nextVersion(position.expected.tag()));
+            if (position.previous->compare_exchange_strong(position.expected, replacement, std::memory_order_acq_rel,
+                                                           std::memory_order_relaxed)) {
+                memory::retire(static_cast<Node*>(current));
+            } else {
+                search(head, order, &key, position);
+            }
+
+            counters[detail::concurrent::counterStripe()].value.fetch_sub(1, std::memory_order_relaxed);
+            return 1;
+        }
+    }
+
+    // Raises the bucket count until the load factor is back in bounds, the new buckets are initialized lazily
+    void grow() {
+        const size_t count = size();
+        size_t mask = bucketMask.load(std::memory_order_relaxed);
+        while (count > (mask + 1) * MaxLoadFactor && mask + 1 < MaxBuckets) {
+            if (bucketMask.compare_exchange_weak(mask, mask * 2 + 1, std::memory_order_relaxed)) {
+                mask = mask * 2 + 1;
+            }
+        }
+    }
+
+    Slot* slot(size_t bucket) const {
+        const size_t segment = detail::concurrent::segmentIndex(bucket);
+        Slot* slots = segments[segment].load(std::memory_order_acquire);
+        return slots == nullptr ? nullptr : slots + (bucket - detail::concurrent::segmentBase(segment));
+    }
+
+    Slot* allocateSlot(size_t bucket) {
+        const size_t segment = detail::concurrent::segmentIndex(bucket);
+        Slot* slots = segments[segment].load(std::memory_order_acquire);
+        if (slots == nullptr) {
+            Slot* allocated = new Slot[detail::concurrent::segmentSize(segment)]();
+            if (segments[segment].compare_exchange_strong(slots, allocated, std::memory_order_acq_rel,
+                                                          std::memory_order_acquire)) {
+                slots = allocated;
+            } else {
+                delete[] allocated;
+            }
+        }
+        return slots + (bucket - detail::concurrent::segmentBase(segment));
+    }
+
+    // Lookups start from the closest ancestor of the bucket that was initialized, which precedes it in the list
+    const NodeBase* bucketForLookup(size_t hash) const {
+        for (size_t bucket = hash & bucketMask.load(std::memory_order_relaxed);;
+             bucket = detail::concurrent::parentBucket(bucket)) {
+            if (const Slot* entry = slot(bucket)) {
+                if (const NodeBase* head = entry->load(std::memory_order_acquire)) {
+                    return head;
+                }
+            }
+        }
+    }
+
+    NodeBase* bucketForUpdate(size_t hash) {
+        return initializedBucket(hash & bucketMask.load(std::memory_order_relaxed));
+    }
+
+    // Splices the sentinel of the bucket into the list after the sentinel of its parent. Threads racing on the same
+    // bucket agree on whichever sentinel made it into the list first.
+    NodeBase* initializedBucket(size_t bucket) {
+        Slot* entry = allocateSlot(bucket);
+        if (NodeBase* head = entry->load(std::memory_order_acquire)) {
+            return head;
+        }
+
+        NodeBase* parent = initializedBucket(detail::concurrent::parentBucket(bucket));
+        auto* sentinel = new NodeBase(detail::concurrent::sentinelOrder(bucket));
+
+        Position position;
+        for (;;) {
+            if (search<K>(parent, sentinel->order, nullptr, position)) {
+                delete sentinel;
+                sentinel = position.current;
+                break;
+            }
+
+            sentinel->next.store(Link(position.current), std::memory_order_relaxed);
+            const Link desired(sentinel, detail::concurrent::nextVersion(position.expected.tag()));
+            if (position.previous->compare_exchange_strong(position.expected, desired, std::memory_order_release,
+                                                           std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        entry->store(sentinel, std::memory_order_release);
+        return sentinel;
+    }
+
+  private:
+    [[no_unique_address]] THash hashFunction;
+    [[no_unique_address]] TEqual equalFunction;
+    std::atomic<size_t> bucketMask;
+    std::array<std::atomic<Slot*>, detail::concurrent::MaxSegments> segments{};
+    std::array<Counter, detail::concurrent::CounterStripes> counters{};
+};
+
+} // namespace hash
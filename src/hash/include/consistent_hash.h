@@ -0,0 +1,376 @@
+#pragma once
+
+#include "dispatch.h"
+#include "hash_util.h"
+#include "murmur.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+
+#ifdef CPPUTILS_HASH_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace hash {
+namespace detail {
+namespace consistent {
+
+inline uint64_t hashKey(std::string_view key) { return detail::murmurHash3x64(key.begin(), key.end(), 0).first; }
+
+// Rendezvous scores are a fixed point log2 of a uniform value, converted to float exactly and multiplied by the
+// inverse weight. There is no float addition the compiler could fuse into a multiply-add (-ffp-contract=fast with
+// FMA), so the SIMD and scalar paths and all builds compute the same score bit for bit and pick the same node.
+constexpr int LogFractionBits = 14;
+
+// log2(1 + x) ~ x * (c0 + x * (c1 + x * (c2 + x * c3))) for x in [0, 1), accurate to about 2.5e-4
+constexpr int32_t Log2Coefficients[] = {23576, -11138, 5336, -1389};
+
+// log2(u) with LogFractionBits fraction bits, for u in (0, 1) an odd multiple of 2^-24 from the top 23 bits of the
+// hash, so it is never 0 or 1. The result is above -24 * 2^LogFractionBits and converts to float exactly.
+constexpr int32_t unitLog2(uint32_t hash) {
+    const uint32_t value = ((hash >> 9) << 1) | 1;
+    const int exponent = std::bit_width(value) - 1;
+    const int32_t fraction = static_cast<int32_t>(((value << (23 - exponent)) >> (23 - LogFractionBits)) & 0x3fff);
+
+    int32_t result = Log2Coefficients[3];
+    for (int c = 2; c >= 0; --c) {
+        result = ((result * fraction) >> LogFractionBits) + Log2Coefficients[c];
+    }
+    result = (result * fraction) >> LogFractionBits;
+    return (exponent - 24) * (int32_t(1) << LogFractionBits) + result;
+}
+
+// Higher is better: log2(u) / weight orders nodes like weight / -ln(u) from the logarithmic method of weighted
+// rendezvous hashing
+inline float rendezvousScore(uint32_t key, uint32_t nodeSeed, float inverseWeight) {
+    return static_cast<float>(unitLog2(detail::fmix<uint32_t>(nodeSeed ^ key))) * inverseWeight;
+}
+
+// Index of the best scoring node, the lowest index wins ties
+using RendezvousBestFunction = size_t (*)(uint32_t key, const uint32_t* seeds, const float* inverseWeights,
+                                          size_t count);
+
+inline size_t rendezvousBestScalar(uint32_t key, const uint32_t* seeds, const float* inverseWeights, size_t count) {
+    size_t best = 0;
+    float bestScore = -std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < count; ++i) {
+        const float score = rendezvousScore(key, seeds[i], inverseWeights[i]);
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+#ifdef CPPUTILS_HASH_DISPATCH
+namespace avx2 {
+CPPUTILS_HASH_TARGET_REGION("avx2")
+
+inline __m256 rendezvousScores(__m256i keys, const uint32_t* seeds, const float* inverseWeights) {
+    __m256i hash = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(seeds)), keys);
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+    hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32(static_cast<int>(0x85ebca6bu)));
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 13));
+    hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32(static_cast<int>(0xc2b2ae35u)));
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+
+    // The float conversion of the odd value is exact and yields its exponent and mantissa like bit_width would
+    const __m256i odd = _mm256_or_si256(_mm256_slli_epi32(_mm256_srli_epi32(hash, 9), 1), _mm256_set1_epi32(1));
+    const __m256i bits = _mm256_castps_si256(_mm256_cvtepi32_ps(odd));
+    const __m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127 + 24));
+    const __m256i fraction =
+        _mm256_and_si256(_mm256_srli_epi32(bits, 23 - LogFractionBits), _mm256_set1_epi32(0x3fff));
+
+    __m256i log = _mm256_set1_epi32(Log2Coefficients[3]);
+    for (int c = 2; c >= 0; --c) {
+        log = _mm256_add_epi32(_mm256_srai_epi32(_mm256_mullo_epi32(log, fraction), LogFractionBits),
+                               _mm256_set1_epi32(Log2Coefficients[c]));
+    }
+    log = _mm256_srai_epi32(_mm256_mullo_epi32(log, fraction), LogFractionBits);
+    log = _mm256_add_epi32(_mm256_slli_epi32(exponent, LogFractionBits), log);
+
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(log), _mm256_loadu_ps(inverseWeights));
+}
+
+// Eight nodes per step. The last partial step runs on padded copies, the padding lanes are masked out of the
+// comparison.
+inline size_t rendezvousBest(uint32_t key, const uint32_t* seeds, const float* inverseWeights, size_t count) {
+    const __m256i keys = _mm256_set1_epi32(static_cast<int>(key));
+    const __m256i limit = _mm256_set1_epi32(static_cast<int>(count));
+
+    __m256 bestScores = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    __m256i bestIndices = _mm256_setzero_si256();
+    __m256i indices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 score;
+        if (i + 8 <= count) {
+            score = rendezvousScores(keys, seeds + i, inverseWeights + i);
+        } else {
+            uint32_t paddedSeeds[8] = {};
+            float paddedWeights[8] = {};
+            std::copy(seeds + i, seeds + count, paddedSeeds);
+            std::copy(inverseWeights + i, inverseWeights + count, paddedWeights);
+            score = rendezvousScores(keys, paddedSeeds, paddedWeights);
+        }
+
+        const __m256 valid = _mm256_castsi256_ps(_mm256_cmpgt_epi32(limit, indices));
+        const __m256 better = _mm256_and_ps(_mm256_cmp_ps(score, bestScores, _CMP_GT_OQ), valid);
+        bestScores = _mm256_blendv_ps(bestScores, score, better);
+        bestIndices = _mm256_castps_si256(
+            _mm256_blendv_ps(_mm256_castsi256_ps(bestIndices), _mm256_castsi256_ps(indices), better));
+        indices = _mm256_add_epi32(indices, _mm256_set1_epi32(8));
+    }
+
+    alignas(32) float scores[8];
+    alignas(32) uint32_t candidates[8];
+    _mm256_store_ps(scores, bestScores);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(candidates), bestIndices);
+
+    size_t best = candidates[0];
+    float bestScore = scores[0];
+    for (size_t lane = 1; lane < 8; ++lane) {
+        if (scores[lane] > bestScore || (scores[lane] == bestScore && candidates[lane] < best)) {
+            bestScore = scores[lane];
+            best = candidates[lane];
+        }
+    }
+    return best;
+}
+
+CPPUTILS_HASH_TARGET_REGION_END
+} // namespace avx2
+#endif
+
+inline RendezvousBestFunction selectRendezvousBest(IsaLevel level = isaLevel()) {
+    static constexpr Kernel<RendezvousBestFunction> Kernels[] = {
+#ifdef CPPUTILS_HASH_DISPATCH
+        {IsaLevel::Avx2, &avx2::rendezvousBest},
+#endif
+        {IsaLevel::Scalar, &rendezvousBestScalar},
+    };
+    return selectKernel(Kernels, level);
+}
+
+inline size_t rendezvousBest(uint32_t key, const uint32_t* seeds, const float* inverseWeights, size_t count) {
+    static const RendezvousBestFunction kernel = selectRendezvousBest();
+    return kernel(key, seeds, inverseWeights, count);
+}
+
+} // namespace consistent
+} // namespace detail
+
+// Jump consistent hash (Lamping and Veach): maps a 64 bit key onto [0, buckets) without any state. Growing from n to
+// n + 1 buckets moves only the keys that land in the new bucket. Buckets can only be added or removed at the end.
+constexpr uint32_t jumpHash(uint64_t key, uint32_t buckets) {
+    if (buckets == 0) {
+        throw std::invalid_argument("jumpHash needs at least one bucket");
+    }
+
+    int64_t bucket = -1;
+    int64_t next = 0;
+    while (next < static_cast<int64_t>(buckets)) {
+        bucket = next;
+        key = key * 2862933555777941757ull + 1;
+        next = static_cast<int64_t>(static_cast<double>(bucket + 1) *
+                                    (static_cast<double>(int64_t(1) << 31) / static_cast<double>((key >> 33) + 1)));
+    }
+    return static_cast<uint32_t>(bucket);
+}
+
+inline uint32_t jumpHash(std::string_view key, uint32_t buckets) {
+    return jumpHash(detail::consistent::hashKey(key), buckets);
+}
+
+// Weighted rendezvous (highest random weight) hashing: every node scores the key and the best score wins, so removing
+// a node only moves the keys it owned and any node can be removed, unlike with jumpHash. A node gets a share of the
+// keys proportional to its weight. Lookups score all nodes, eight at a time with AVX2, which is the fastest option
+// for up to a few hundred nodes. Ties go to the lower node id, so the result does not depend on insertion order.
+class RendezvousHash {
+  public:
+    // Adds the node or updates its weight
+    void insert(uint64_t node, double weight = 1.0) {
+        if (!(weight > 0) || !std::isfinite(weight)) {
+            throw std::invalid_argument("Rendezvous weights must be positive");
+        }
+
+        const auto position = std::lower_bound(nodes.begin(), nodes.end(), node);
+        const size_t index = static_cast<size_t>(position - nodes.begin());
+        const float inverseWeight = static_cast<float>(1 / weight);
+
+        if (position != nodes.end() && *position == node) {
+            inverseWeights[index] = inverseWeight;
+            return;
+        }
+
+        nodes.insert(position, node);
+        seeds.insert(seeds.begin() + static_cast<std::ptrdiff_t>(index),
+                     static_cast<uint32_t>(detail::fmix<uint64_t>(node)));
+        inverseWeights.insert(inverseWeights.begin() + static_cast<std::ptrdiff_t>(index), inverseWeight);
+    }
+
+    bool erase(uint64_t node) {
+        const auto position = std::lower_bound(nodes.begin(), nodes.end(), node);
+        if (position == nodes.end() || *position != node) {
+            return false;
+        }
+
+        const auto index = position - nodes.begin();
+        nodes.erase(position);
+        seeds.erase(seeds.begin() + index);
+        inverseWeights.erase(inverseWeights.begin() + index);
+        return true;
+    }
+
+    // Node owning an already hashed key
+    uint64_t lookup(uint64_t keyHash) const {
+        if (nodes.empty()) {
+            throw std::out_of_range("RendezvousHash has no nodes");
+        }
+        const uint32_t key = static_cast<uint32_t>(keyHash ^ (keyHash >> 32));
+        return nodes[detail::consistent::rendezvousBest(key, seeds.data(), inverseWeights.data(), nodes.size())];
+    }
+
+    uint64_t lookup(std::string_view key) const { return lookup(detail::consistent::hashKey(key)); }
+
+    size_t size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+
+  private:
+    // Sorted by node id, structure of arrays for the scoring loop
+    std::vector<uint64_t> nodes;
+    std::vector<uint32_t> seeds;
+    std::vector<float> inverseWeights;
+};
+
+// Consistent hash ring with virtual nodes and bounded loads (Mirrokni, Thorup and Zadimoghaddam). lookup walks
+// clockwise to the next virtual node in O(log n). acquire additionally keeps every node below
+// ceil((1 + epsilon) * average load) by skipping full nodes, and release gives the load back.
+class HashRing {
+  public:
+    explicit HashRing(size_t virtualNodes = 100, double epsilon = 0.25)
+        : virtualNodes(virtualNodes), epsilon(epsilon) {
+        if (virtualNodes == 0 || !(epsilon > 0)) {
+            throw std::invalid_argument("HashRing needs virtual nodes and a positive epsilon");
+        }
+    }
+
+    void insert(uint64_t node) {
+        if (std::find(nodes.begin(), nodes.end(), node) != nodes.end()) {
+            return;
+        }
+        nodes.push_back(node);
+        loads.push_back(0);
+        rebuild();
+    }
+
+    // Keys acquired on the node stop counting towards the total load
+    bool erase(uint64_t node) {
+        const auto position = std::find(nodes.begin(), nodes.end(), node);
+        if (position == nodes.end()) {
+            return false;
+        }
+        const auto index = position - nodes.begin();
+        totalLoad -= loads[static_cast<size_t>(index)];
+        nodes.erase(position);
+        loads.erase(loads.begin() + index);
+        rebuild();
+        return true;
+    }
+
+    uint64_t lookup(uint64_t keyHash) const { return nodes[owners[firstPoint(keyHash)]]; }
+    uint64_t lookup(std::string_view key) const { return lookup(detail::consistent::hashKey(key)); }
+
+    // Places one unit of load for the key on the first node along the ring that still has capacity
+    uint64_t acquire(uint64_t keyHash) {
+        const size_t start = firstPoint(keyHash);
+        const uint64_t capacity = static_cast<uint64_t>(
+            std::ceil((1 + epsilon) * static_cast<double>(totalLoad + 1) / static_cast<double>(nodes.size())));
+
+        for (size_t step = 0; step < points.size(); ++step) {
+            const uint32_t owner = owners[(start + step) % points.size()];
+            if (loads[owner] < capacity) {
+                ++loads[owner];
+                ++totalLoad;
+                return nodes[owner];
+            }
+        }
+        // Unreachable, the capacity is above the average load so some node has room
+        throw std::logic_error("HashRing has no node with spare capacity");
+    }
+
+    uint64_t acquire(std::string_view key) { return acquire(detail::consistent::hashKey(key)); }
+
+    void release(uint64_t node) {
+        const auto position = std::find(nodes.begin(), nodes.end(), node);
+        if (position != nodes.end() && loads[static_cast<size_t>(position - nodes.begin())] > 0) {
+            --loads[static_cast<size_t>(position - nodes.begin())];
+            --totalLoad;
+        }
+    }
+
+    uint64_t load(uint64_t node) const {
+        const auto position = std::find(nodes.begin(), nodes.end(), node);
+        return position != nodes.end() ? loads[static_cast<size_t>(position - nodes.begin())] : 0;
+    }
+
+    size_t size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+
+  private:
+    size_t firstPoint(uint64_t keyHash) const {
+        if (points.empty()) {
+            throw std::out_of_range("HashRing has no nodes");
+        }
+        const auto position = std::lower_bound(points.begin(), points.end(), keyHash);
+        const size_t index = static_cast<size_t>(position - points.begin());
+        return index == points.size() ? 0 : index;
+    }
+
+    void rebuild() {
+        struct Point {
+            uint64_t position;
+            uint64_t node;
+            uint32_t index;
+        };
+
+        std::vector<Point> ring;
+        ring.reserve(nodes.size() * virtualNodes);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (size_t replica = 0; replica < virtualNodes; ++replica) {
+                const uint64_t position = detail::fmix<uint64_t>(nodes[i] * 0x9e3779b97f4a7c15ull + replica);
+                ring.push_back({position, nodes[i], static_cast<uint32_t>(i)});
+            }
+        }
+        // Equal positions are ordered by node id so the ring does not depend on insertion order
+        std::sort(ring.begin(), ring.end(), [](const Point& lhs, const Point& rhs) {
+            return lhs.position != rhs.position ? lhs.position < rhs.position : lhs.node < rhs.node;
+        });
+
+        points.resize(ring.size());
+        owners.resize(ring.size());
+        for (size_t i = 0; i < ring.size(); ++i) {
+            points[i] = ring[i].position;
+            owners[i] = ring[i].index;
+        }
+    }
+
+  private:
+    size_t virtualNodes;
+    double epsilon;
+    uint64_t totalLoad = 0;
+    std::vector<uint64_t> nodes;
+    std::vector<uint64_t> loads;
+    // Ring positions in ascending order and the index of the node owning each
+    std::vector<uint64_t> points;
+    std::vector<uint32_t> owners;
+};
+
+} // namespace hash
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "dispatch.h"
+#include "hash_util.h"
+
+#include <array>
+#include <iterator>
+#include <stdint.h>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPPUTILS_HASH_CRC32C_HARDWARE 1
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+namespace hash {
+namespace detail {
+
+// Castagnoli polynomial, bit reflected
+constexpr uint32_t Crc32cPolynomial = 0x82f63b78;
+
+using Crc32cTable = std::array<std::array<uint32_t, 256>, 8>;
+
+constexpr Crc32cTable makeCrc32cTable() {
+    Crc32cTable table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (size_t bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? Crc32cPolynomial : 0);
+        }
+        table[0][i] = crc;
+    }
+    for (size_t slice = 1; slice < table.size(); ++slice) {
+        for (size_t i = 0; i < 256; ++i) {
+            table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xff];
+        }
+    }
+    return table;
+}
+
+inline constexpr Crc32cTable Crc32cTables = makeCrc32cTable();
+
+// Multiplies two polynomials modulo the CRC polynomial, both in the reflected representation
+constexpr uint32_t multiplyModulo(uint32_t lhs, uint32_t rhs) {
+    uint32_t product = 0;
+    for (uint32_t mask = 1u << 31; mask != 0; mask >>= 1) {
+        if (lhs & mask) {
+            product ^= rhs;
+        }
+        rhs = (rhs >> 1) ^ ((rhs & 1) ? Crc32cPolynomial : 0);
+    }
+    return product;
+}
+
+// x^exponent modulo the CRC polynomial
+constexpr uint32_t xPowerModulo(uint64_t exponent) {
+    uint32_t result = 1u << 31;
+    uint32_t power = 1u << 30;
+    for (; exponent != 0; exponent >>= 1) {
+        if (exponent & 1) {
+            result = multiplyModulo(result, power);
+        }
+        power = multiplyModulo(power, power);
+    }
+    return result;
+}
+
+constexpr uint32_t crc32cByte(uint32_t crc, uint8_t byte) { return (crc >> 8) ^ Crc32cTables[0][(crc ^ byte) & 0xff]; }
+
+// Slicing-by-8 over the raw (not inverted) CRC state
+inline uint32_t crc32cTable(uint32_t crc, const uint8_t* data, size_t length) {
+    const Crc32cTable& table = Crc32cTables;
+
+    for (; length >= 8; data += 8, length -= 8) {
+        const uint64_t word = load<uint64_t>(data) ^ crc;
+        crc = table[7][word & 0xff] ^ table[6][(word >> 8) & 0xff] ^ table[5][(word >> 16) & 0xff] ^
+              table[4][(word >> 24) & 0xff] ^ table[3][(word >> 32) & 0xff] ^ table[2][(word >> 40) & 0xff] ^
+              table[1][(word >> 48) & 0xff] ^ table[0][word >> 56];
+    }
+
+    for (; length != 0; ++data, --length) {
+        crc = crc32cByte(crc, *data);
+    }
+    return crc;
+}
+
+#ifdef CPPUTILS_HASH_CRC32C_HARDWARE
+CPPUTILS_HASH_TARGET("sse4.2") inline uint32_t crc32cHardware(uint32_t crc, const uint8_t* data, size_t length) {
+    uint64_t state = crc;
+    for (; length >= 8; data += 8, length -= 8) {
+        state = _mm_crc32_u64(state, load<uint64_t>(data));
+    }
+    for (; length != 0; ++data, --length) {
+        state = _mm_crc32_u8(static_cast<uint32_t>(state), *data);
+    }
+    return static_cast<uint32_t>(state);
+}
+
+// Advances the state over BlockSize zero bytes. The carry-less product is one bit short and the crc32 instruction
+// multiplies by another x^32, hence the constant is x^(8 * BlockSize - 33).
+template <size_t BlockSize> CPPUTILS_HASH_TARGET("sse4.2,pclmul") inline uint64_t crc32cShift(uint64_t crc) {
+    constexpr uint32_t Constant = xPowerModulo(8 * BlockSize - 33);
+    const __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<int64_t>(crc)),
+                                                 _mm_cvtsi32_si128(static_cast<int>(Constant)), 0);
+    return _mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(product)));
+}
+
+// Runs three independent streams to hide the latency of the crc32 instruction and folds them back together
+template <size_t BlockSize>
+CPPUTILS_HASH_TARGET("sse4.2,pclmul")
+inline uint64_t crc32cThreeWay(uint64_t crc, const uint8_t*& data, size_t& length) {
+    for (; length >= 3 * BlockSize; data += 3 * BlockSize, length -= 3 * BlockSize) {
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+        for (size_t i = 0; i < BlockSize; i += 8) {
+            crc = _mm_crc32_u64(crc, load<uint64_t>(data + i));
+            crc1 = _mm_crc32_u64(crc1, load<uint64_t>(data + BlockSize + i));
+            crc2 = _mm_crc32_u64(crc2, load<uint64_t>(data + 2 * BlockSize + i));
+        }
+        crc = crc32cShift<BlockSize>(crc) ^ crc1;
+        crc = crc32cShift<BlockSize>(crc) ^ crc2;
+    }
+    return crc;
+}
+
+CPPUTILS_HASH_TARGET("sse4.2,pclmul")
+inline uint32_t crc32cHardwareFolded(uint32_t crc, const uint8_t* data, size_t length) {
+    uint64_t state = crc;
+    state = crc32cThreeWay<2048>(state, data, length);
+    state = crc32cThreeWay<128>(state, data, length);
+    return crc32cHardware(static_cast<uint32_t>(state), data, length);
+}
+#endif
+
+using Crc32cFunction = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+inline Crc32cFunction selectCrc32c(IsaLevel level = isaLevel()) {
+#ifdef CPPUTILS_HASH_CRC32C_HARDWARE
+    // Folding the three streams back together needs carry-less multiplication, which is not part of the level
+    if (level >= IsaLevel::Sse42) {
+        return cpuFeatures().pclmul ? crc32cHardwareFolded : crc32cHardware;
+    }
+#endif
+    return crc32cTable;
+}
+
+inline uint32_t crc32cUpdate(uint32_t crc, const uint8_t* data, size_t length) {
+    static const Crc32cFunction function = selectCrc32c();
+    return function(crc, data, length);
+}
+
+} // namespace detail
+
+// CRC32C (Castagnoli) checksum. Passing the result of a previous call as crc continues the checksum, so data can be
+// fed in chunks.
+template <typename TBegin, std::sentinel_for<TBegin> TEnd>
+constexpr uint32_t crc32c(const TBegin& begin, const TEnd& end, uint32_t crc = 0) {
+    static_assert(sizeof(*begin) == 1, "Iterators must produce single byte values");
+
+    crc = ~crc;
+
+    if constexpr (detail::ContiguousBytes<TBegin, TEnd>) {
+        if (!std::is_constant_evaluated()) {
+            return ~detail::crc32cUpdate(crc, detail::bytePointer(begin), static_cast<size_t>(end - begin));
+        }
+    }
+
+    for (auto iterator = begin; iterator != end; ++iterator) {
+        crc = detail::crc32cByte(crc, static_cast<uint8_t>(*iterator));
+    }
+    return ~crc;
+}
+
+constexpr uint32_t crc32c(const std::string_view& stringView, uint32_t crc = 0) {
+    return crc32c(stringView.begin(), stringView.end(), crc);
+}
+
+// Checksum of the concatenation of two chunks, given the checksum of each chunk and the length of the second one
+constexpr uint32_t crc32cCombine(uint32_t first, uint32_t second, size_t secondLength) {
+    return detail::multiplyModulo(first, detail::xPowerModulo(8 * static_cast<uint64_t>(secondLength))) ^ second;
+}
+
+} // namespace hash
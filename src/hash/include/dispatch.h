@@ -0,0 +1,111 @@
+#pragma once
+
+#include "hash_util.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string_view>
+
+// Kernels for an instruction set are compiled inside a target region, which enables the extensions for every function
+// defined in it, templates included, without changing the flags of the rest of the program. The region has to be
+// closed in the same namespace it was opened in. MSVC allows any intrinsic anywhere and needs no regions.
+#define CPPUTILS_HASH_PRAGMA(x) _Pragma(#x)
+
+#if defined(__clang__)
+#define CPPUTILS_HASH_TARGET_REGION(features)                                                                          \
+    CPPUTILS_HASH_PRAGMA(clang attribute push(__attribute__((target(features))), apply_to = function))
+#define CPPUTILS_HASH_TARGET_REGION_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+#define CPPUTILS_HASH_TARGET_REGION(features) _Pragma("GCC push_options") CPPUTILS_HASH_PRAGMA(GCC target(features))
+#define CPPUTILS_HASH_TARGET_REGION_END _Pragma("GCC pop_options")
+#else
+#define CPPUTILS_HASH_TARGET_REGION(features)
+#define CPPUTILS_HASH_TARGET_REGION_END
+#endif
+
+// Runtime dispatch is available where kernels for newer instruction sets can be compiled into a baseline build
+#if defined(CPPUTILS_HASH_X86) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define CPPUTILS_HASH_DISPATCH 1
+#endif
+
+namespace hash {
+
+// Instruction set levels of the hash kernels, each one includes the ones before it
+enum class IsaLevel : uint8_t {
+    Scalar,
+    Sse42,
+    Avx2,
+    Avx512,
+};
+
+constexpr std::string_view isaName(IsaLevel level) {
+    switch (level) {
+    case IsaLevel::Scalar: return "scalar";
+    case IsaLevel::Sse42: return "sse4.2";
+    case IsaLevel::Avx2: return "avx2";
+    case IsaLevel::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+namespace detail {
+namespace dispatch {
+
+inline IsaLevel detectIsaLevel() {
+    const CpuFeatures& features = cpuFeatures();
+    if (features.avx512f && features.avx2 && features.sse42) {
+        return IsaLevel::Avx512;
+    }
+    if (features.avx2 && features.sse42) {
+        return IsaLevel::Avx2;
+    }
+    return features.sse42 ? IsaLevel::Sse42 : IsaLevel::Scalar;
+}
+
+// CPPUTILS_HASH_ISA=scalar|sse4.2|avx2|avx512 lowers the level, for testing fallbacks and working around hosts that
+// throttle on wide vectors. It never raises the level above what the CPU supports.
+inline IsaLevel isaLimit() {
+    const char* value = getenv("CPPUTILS_HASH_ISA");
+    if (value == nullptr) {
+        return IsaLevel::Avx512;
+    }
+    for (const IsaLevel level : {IsaLevel::Scalar, IsaLevel::Sse42, IsaLevel::Avx2}) {
+        if (isaName(level) == value) {
+            return level;
+        }
+    }
+    return IsaLevel::Avx512;
+}
+
+} // namespace dispatch
+} // namespace detail
+
+// Level used by the dispatched kernels, detected with CPUID on first use and fixed for the rest of the process
+inline IsaLevel isaLevel() {
+    static const IsaLevel level = std::min(detail::dispatch::detectIsaLevel(), detail::dispatch::isaLimit());
+    return level;
+}
+
+namespace detail {
+
+// A function pointer, or a set of them, built for one instruction set level
+template <typename T> struct Kernel {
+    IsaLevel level;
+    T implementation;
+};
+
+// First kernel whose level the host supports, kernels are listed from the best to a scalar one at the end. Callers
+// keep the result in a function local static, so the choice is made once and a call costs one indirect branch.
+template <typename T, size_t Count> T selectKernel(const Kernel<T> (&kernels)[Count], IsaLevel level = isaLevel()) {
+    static_assert(Count > 0, "selectKernel needs a kernel");
+    for (const Kernel<T>& kernel : kernels) {
+        if (kernel.level <= level) {
+            return kernel.implementation;
+        }
+    }
+    return kernels[Count - 1].implementation;
+}
+
+} // namespace detail
+} // namespace hash
@@ -0,0 +1,595 @@
+#pragma once
+
+#include "hasher.h"
+#include "murmur.h"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace hash {
+
+// Default hasher for FlatHashMap. Strings go through MurmurHash3, integers through the murmur finalizer, 128 bit
+// integers, pairs, tuples and arrays through combine and anything else through std::hash followed by the finalizer,
+// since the table uses the low bits of the hash directly.
+struct DefaultHasher {
+    using is_transparent = void;
+
+    size_t operator()(const std::string_view& stringView) const {
+        return static_cast<size_t>(detail::murmurHash3x64(stringView.begin(), stringView.end(), 0).first);
+    }
+
+    template <std::integral T>
+        requires(sizeof(T) <= sizeof(uint64_t))
+    size_t operator()(T value) const {
+        return static_cast<size_t>(detail::fmix(static_cast<uint64_t>(value)));
+    }
+
+    // Both halves of a 128 bit integer, the finalizer alone would only see the low one
+    template <detail::composite::Wide T> size_t operator()(T value) const {
+        return static_cast<size_t>(combine(value));
+    }
+
+    template <detail::composite::TupleLike T> size_t operator()(const T& value) const {
+        return static_cast<size_t>(combine(value));
+    }
+
+    template <typename T>
+        requires(!std::integral<T> && !detail::composite::Wide<T> &&
+                 !std::convertible_to<const T&, std::string_view> && !detail::composite::TupleLike<T>)
+    size_t operator()(const T& value) const {
+        return static_cast<size_t>(detail::fmix(static_cast<uint64_t>(std::hash<T>()(value))));
+    }
+};
+
+namespace detail {
+namespace swiss {
+
+// Control bytes: a full slot stores the low 7 bits of its hash, everything else is negative
+using Control = int8_t;
+constexpr Control Empty = -128;
+constexpr Control Deleted = -2;
+constexpr Control Sentinel = -1;
+
+constexpr size_t GroupWidth = 16;
+
+// Control bytes of a table without any slots, so that lookups in an empty map need no allocation
+alignas(GroupWidth) inline constexpr Control EmptyGroup[GroupWidth] = {
+    Sentinel, Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty,
+};
+
+constexpr bool isFull(Control control) { return control >= 0; }
+
+constexpr size_t h1(size_t hash) { return hash >> 7; }
+constexpr Control h2(size_t hash) { return static_cast<Control>(hash & 0x7f); }
+
+// One bit per control byte in a group
+class BitMask {
+  public:
+    explicit BitMask(uint32_t mask) : mask(mask) {}
+
+    explicit operator bool() const { return mask != 0; }
+
+    uint32_t lowest() const { return static_cast<uint32_t>(std::countr_zero(mask)); }
+    uint32_t trailingZeros() const { return static_cast<uint32_t>(std::countr_zero(mask)); }
+    uint32_t leadingZeros() const { return static_cast<uint32_t>(std::countl_zero(static_cast<uint16_t>(mask))); }
+
+    BitMask& operator++() {
+        mask &= mask - 1;
+        return *this;
+    }
+
+  private:
+    uint32_t mask;
+};
+
+#if defined(__SSE2__) || defined(_M_X64)
+class Group {
+  public:
+    explicit Group(const Control* control) : control(_mm_loadu_si128(reinterpret_cast<const __m128i*>(control))) {}
+
+    BitMask match(Control hash) const { return mask(_mm_cmpeq_epi8(_mm_set1_epi8(hash), control)); }
+
+    BitMask matchEmpty() const { return mask(_mm_cmpeq_epi8(_mm_set1_epi8(Empty), control)); }
+
+    BitMask matchEmptyOrDeleted() const { return mask(_mm_cmpgt_epi8(_mm_set1_epi8(Sentinel), control)); }
+
+  private:
+    static BitMask mask(__m128i bytes) { return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(bytes))); }
+
+  private:
+    __m128i control;
+};
+#else
+class Group {
+  public:
+    explicit Group(const Control* control) { memcpy(this->control, control, GroupWidth); }
+
+    BitMask match(Control hash) const {
+        return collect([hash](Control control) { return control == hash; });
+    }
+
+    BitMask matchEmpty() const {
+        return collect([](Control control) { return control == Empty; });
+    }
+
+    BitMask matchEmptyOrDeleted() const {
+        return collect([](Control control) { return control < Sentinel; });
+    }
+
+  private:
+    template <typename F> BitMask collect(F&& predicate) const {
+        uint32_t result = 0;
+        for (size_t i = 0; i < GroupWidth; ++i) {
+            result |= static_cast<uint32_t>(predicate(control[i])) << i;
+        }
+        return BitMask(result);
+    }
+
+  private:
+    Control control[GroupWidth];
+};
+#endif
+
+// Triangular probing over groups, visits every group once when the capacity is one less than a power of two
+class ProbeSequence {
+  public:
+    ProbeSequence(size_t hash, size_t mask) : mask(mask), position(hash & mask) {}
+
+    size_t offset() const { return position; }
+    size_t offset(size_t i) const { return (position + i) & mask; }
+
+    void next() {
+        index += GroupWidth;
+        position = (position + index) & mask;
+    }
+
+  private:
+    size_t mask;
+    size_t position;
+    size_t index = 0;
+};
+
+// Capacity is always 2^n - 1, so that it doubles as the probe mask
+constexpr size_t normalizeCapacity(size_t capacity) {
+    return capacity < GroupWidth - 1 ? GroupWidth - 1 : std::bit_ceil(capacity + 1) - 1;
+}
+
+// Maximum load factor of 7/8
+constexpr size_t capacityToGrowth(size_t capacity) { return capacity - capacity / 8; }
+constexpr size_t growthToCapacity(size_t growth) { return growth + (growth == 0 ? 0 : (growth - 1) / 7); }
+
+template <typename K, typename V> union Slot {
+    Slot() {}
+    ~Slot() {}
+
+    std::pair<const K, V> value;
+    // Same layout with a mutable key, only used to move entries while rehashing
+    std::pair<K, V> mutableValue;
+};
+
+} // namespace swiss
+} // namespace detail
+
+// Open addressing hash map in the style of Swiss tables. Entries live inline in one allocation together with a byte
+// of control data each, and lookups scan 16 control bytes at a time. Any rehash invalidates iterators and references.
+template <typename K, typename V, typename THash = DefaultHasher, typename TEqual = std::equal_to<>>
+class FlatHashMap {
+  private:
+    using Control = detail::swiss::Control;
+    using Group = detail::swiss::Group;
+    using ProbeSequence = detail::swiss::ProbeSequence;
+    using Slot = detail::swiss::Slot<K, V>;
+
+    static constexpr size_t GroupWidth = detail::swiss::GroupWidth;
+
+    // Lookups with other key types, such as std::string_view for std::string keys, need both functors to opt in
+    static constexpr bool IsTransparent =
+        requires { typename THash::is_transparent; } && requires { typename TEqual::is_transparent; };
+
+  public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = size_t;
+    using hasher = THash;
+    using key_equal = TEqual;
+
+    template <bool Const> class Iterator {
+      private:
+        friend class FlatHashMap;
+        template <bool> friend class Iterator;
+
+        using TValue = std::conditional_t<Const, const std::pair<const K, V>, std::pair<const K, V>>;
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, V>;
+        using difference_type = ptrdiff_t;
+        using reference = TValue&;
+        using pointer = TValue*;
+
+        Iterator() = default;
+
+        template <bool OtherConst>
+            requires(Const && !OtherConst)
+        Iterator(const Iterator<OtherConst>& other) : control(other.control), slot(other.slot) {}
+
+        reference operator*() const { return slot->value; }
+        pointer operator->() const { return &slot->value; }
+
+        Iterator& operator++() {
+            ++control;
+            ++slot;
+            skipEmpty();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) { return lhs.control == rhs.control; }
+
+      private:
+        Iterator(const Control* control, Slot* slot) : control(control), slot(slot) {}
+
+        void skipEmpty() {
+            while (*control < detail::swiss::Sentinel) {
+                ++control;
+                ++slot;
+            }
+            if (*control == detail::swiss::Sentinel) {
+                control = nullptr;
+            }
+        }
+
+      private:
+        const Control* control = nullptr;
+        Slot* slot = nullptr;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+  public:
+    FlatHashMap() = default;
+
+    explicit FlatHashMap(size_t capacity, const THash& hash = THash(), const TEqual& equal = TEqual())
+        : hashFunction(hash), equalFunction(equal) {
+        reserve(capacity);
+    }
+
+    FlatHashMap(std::initializer_list<value_type> values) {
+        reserve(values.size());
+        for (const value_type& value : values) {
+            insert(value);
+        }
+    }
+
+    FlatHashMap(const FlatHashMap& other) : hashFunction(other.hashFunction), equalFunction(other.equalFunction) {
+        reserve(other.size());
+        for (const value_type& value : other) {
+            insert(value);
+        }
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept
+        : hashFunction(std::move(other.hashFunction)), equalFunction(std::move(other.equalFunction)) {
+        steal(other);
+    }
+
+    ~FlatHashMap() { destroy(); }
+
+    FlatHashMap& operator=(const FlatHashMap& other) {
+        if (this != &other) {
+            FlatHashMap copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            hashFunction = std::move(other.hashFunction);
+            equalFunction = std::move(other.equalFunction);
+            steal(other);
+        }
+        return *this;
+    }
+
+    iterator begin() {
+        iterator result(control, slots);
+        result.skipEmpty();
+        return result;
+    }
+    iterator end() { return {}; }
+
+    const_iterator begin() const { return const_cast<FlatHashMap*>(this)->begin(); }
+    const_iterator end() const { return {}; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return mask; }
+
+    void clear() {
+        destroy();
+        control = const_cast<Control*>(detail::swiss::EmptyGroup);
+        slots = nullptr;
+        mask = 0;
+        count = 0;
+        growthLeft = 0;
+    }
+
+    // Makes room for at least count entries without rehashing
+    void reserve(size_t count) {
+        if (count > detail::swiss::capacityToGrowth(mask)) {
+            rehash(detail::swiss::normalizeCapacity(detail::swiss::growthToCapacity(count)));
+        }
+    }
+
+    iterator find(const K& key) { return iteratorAt(findIndex(key, hashFunction(key))); }
+    const_iterator find(const K& key) const { return const_cast<FlatHashMap*>(this)->find(key); }
+
+    template <typename TKey>
+        requires(IsTransparent)
+    iterator find(const TKey& key) {
+        return iteratorAt(findIndex(key, hashFunction(key)));
+    }
+
+    template <typename TKey>
+        requires(IsTransparent)
+    const_iterator find(const TKey& key) const {
+        return const_cast<FlatHashMap*>(this)->find(key);
+    }
+
+    bool contains(const K& key) const { return findIndex(key, hashFunction(key)) != NotFound; }
+
+    template <typename TKey>
+        requires(IsTransparent)
+    bool contains(const TKey& key) const {
+        return findIndex(key, hashFunction(key)) != NotFound;
+    }
+
+    V& at(const K& key) { return checked(find(key))->second; }
+    const V& at(const K& key) const { return const_cast<FlatHashMap*>(this)->at(key); }
+
+    template <typename TKey>
+        requires(IsTransparent)
+    V& at(const TKey& key) {
+        return checked(find(key))->second;
+    }
+
+    template <typename TKey>
+        requires(IsTransparent)
+    const V& at(const TKey& key) const {
+        return const_cast<FlatHashMap*>(this)->at(key);
+    }
+
+    // Constructs V(args...) unless the key is already present, returns the entry and whether it was inserted. With a
+    // transparent hasher the key is only converted to K when it is actually inserted.
+    template <typename TKey, typename... TArgs>
+        requires(std::same_as<std::remove_cvref_t<TKey>, K> || (IsTransparent && std::constructible_from<K, TKey>))
+    std::pair<iterator, bool> tryEmplace(TKey&& key, TArgs&&... args) {
+        const size_t hash = hashFunction(key);
+        size_t index = findIndex(key, hash);
+        if (index != NotFound) {
+            return {iteratorAt(index), false};
+        }
+
+        index = prepareInsert(hash);
+        std::construct_at(&slots[index].value, std::piecewise_construct, std::forward_as_tuple(std::forward<TKey>(key)),
+                          std::forward_as_tuple(std::forward<TArgs>(args)...));
+        commitInsert(index, hash);
+        return {iteratorAt(index), true};
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return tryEmplace(value.first, value.second); }
+    std::pair<iterator, bool> insert(value_type&& value) { return tryEmplace(value.first, std::move(value.second)); }
+
+    V& operator[](const K& key) { return tryEmplace(key).first->second; }
+    V& operator[](K&& key) { return tryEmplace(std::move(key)).first->second; }
+
+    template <typename TKey>
+        requires(!std::same_as<std::remove_cvref_t<TKey>, K> && IsTransparent && std::constructible_from<K, TKey>)
+    V& operator[](TKey&& key) {
+        return tryEmplace(std::forward<TKey>(key)).first->second;
+    }
+
+    void erase(const_iterator position) { eraseIndex(static_cast<size_t>(position.control - control)); }
+    void erase(iterator position) { erase(const_iterator(position)); }
+
+    size_t erase(const K& key) { return eraseIndex(findIndex(key, hashFunction(key))); }
+
+    template <typename TKey>
+        requires(IsTransparent)
+    size_t erase(const TKey& key) {
+        return eraseIndex(findIndex(key, hashFunction(key)));
+    }
+
+  private:
+    static constexpr size_t NotFound = ~size_t(0);
+
+    template <typename TKey> size_t findIndex(const TKey& key, size_t hash) const {
+        ProbeSequence sequence(detail::swiss::h1(hash), mask);
+        while (true) {
+            const Group group(control + sequence.offset());
+            for (detail::swiss::BitMask match = group.match(detail::swiss::h2(hash)); match; ++match) {
+                const size_t index = sequence.offset(match.lowest());
+                if (equalFunction(slots[index].value.first, key)) {
+                    return index;
+                }
+            }
+            if (group.matchEmpty()) {
+                return NotFound;
+            }
+            sequence.next();
+        }
+    }
+
+    iterator iteratorAt(size_t index) { return index == NotFound ? end() : iterator(control + index, slots + index); }
+
+    static iterator checked(iterator it) {
+        if (it == iterator()) {
+            throw std::out_of_range("FlatHashMap: key not found");
+        }
+        return it;
+    }
+
+    size_t findFirstNonFull(size_t hash) const {
+        ProbeSequence sequence(detail::swiss::h1(hash), mask);
+        while (true) {
+            const detail::swiss::BitMask free = Group(control + sequence.offset()).matchEmptyOrDeleted();
+            if (free) {
+                return sequence.offset(free.lowest());
+            }
+            sequence.next();
+        }
+    }
+
+    // Picks the slot for a new entry, growing first if needed. Tombstones are reused without using up growth.
+    size_t prepareInsert(size_t hash) {
+        size_t index = findFirstNonFull(hash);
+        if (growthLeft == 0 && control[index] != detail::swiss::Deleted) {
+            if (mask == 0) {
+                rehash(detail::swiss::normalizeCapacity(0));
+            } else if (count <= detail::swiss::capacityToGrowth(mask) / 2) {
+                // Mostly tombstones, rehashing in place reclaims them
+                rehash(mask);
+            } else {
+                rehash(mask * 2 + 1);
+            }
+            index = findFirstNonFull(hash);
+        }
+        return index;
+    }
+
+    void commitInsert(size_t index, size_t hash) {
+        growthLeft -= control[index] == detail::swiss::Empty;
+        setControl(index, detail::swiss::h2(hash));
+        ++count;
+    }
+
+    size_t eraseIndex(size_t index) {
+        if (index == NotFound) {
+            return 0;
+        }
+
+        std::destroy_at(&slots[index].value);
+        --count;
+
+        // A slot can go straight back to empty if no probe sequence can have passed over it while it was full, which is
+        // the case when no window of GroupWidth bytes around it was ever entirely full
+        const size_t before = (index - GroupWidth) & mask;
+        const detail::swiss::BitMask emptyAfter = Group(control + index).matchEmpty();
+        const detail::swiss::BitMask emptyBefore = Group(control + before).matchEmpty();
+        const bool wasNeverFull =
+            emptyBefore && emptyAfter && emptyAfter.trailingZeros() + emptyBefore.leadingZeros() < GroupWidth;
+
+        setControl(index, wasNeverFull ? detail::swiss::Empty : detail::swiss::Deleted);
+        growthLeft += wasNeverFull;
+        return 1;
+    }
+
+    // Also mirrors the first GroupWidth - 1 bytes after the sentinel, so a group load never has to wrap around
+    void setControl(size_t index, Control value) {
+        control[index] = value;
+        control[((index - (GroupWidth - 1)) & mask) + ((GroupWidth - 1) & mask)] = value;
+    }
+
+    static size_t slotOffset(size_t capacity) {
+        return (capacity + GroupWidth + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+    }
+
+    static constexpr std::align_val_t Alignment{std::max(alignof(Slot), GroupWidth)};
+
+    void rehash(size_t capacity) {
+        std::byte* memory =
+            static_cast<std::byte*>(::operator new(slotOffset(capacity) + capacity * sizeof(Slot), Alignment));
+
+        Control* oldControl = control;
+        Slot* oldSlots = slots;
+        const size_t oldCapacity = mask;
+
+        control = reinterpret_cast<Control*>(memory);
+        slots = reinterpret_cast<Slot*>(memory + slotOffset(capacity));
+        mask = capacity;
+        memset(control, detail::swiss::Empty, capacity + GroupWidth);
+        control[capacity] = detail::swiss::Sentinel;
+
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (!detail::swiss::isFull(oldControl[i])) {
+                continue;
+            }
+
+            const size_t hash = hashFunction(oldSlots[i].value.first);
+            const size_t index = findFirstNonFull(hash);
+            setControl(index, detail::swiss::h2(hash));
+            std::construct_at(&slots[index].mutableValue, std::move(oldSlots[i].mutableValue));
+            std::destroy_at(&oldSlots[i].mutableValue);
+        }
+
+        growthLeft = detail::swiss::capacityToGrowth(capacity) - count;
+
+        if (oldCapacity != 0) {
+            ::operator delete(oldControl, Alignment);
+        }
+    }
+
+    void destroy() {
+        if (mask == 0) {
+            return;
+        }
+
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            for (size_t i = 0; i < mask; ++i) {
+                if (detail::swiss::isFull(control[i])) {
+                    std::destroy_at(&slots[i].value);
+                }
+            }
+        }
+        ::operator delete(control, Alignment);
+    }
+
+    void steal(FlatHashMap& other) {
+        control = std::exchange(other.control, const_cast<Control*>(detail::swiss::EmptyGroup));
+        slots = std::exchange(other.slots, nullptr);
+        mask = std::exchange(other.mask, 0);
+        count = std::exchange(other.count, 0);
+        growthLeft = std::exchange(other.growthLeft, 0);
+    }
+
+  private:
+    // Points at the shared read only empty group while nothing is allocated, which is never written to since
+    // growthLeft is zero
+    Control* control = const_cast<Control*>(detail::swiss::EmptyGroup);
+    Slot* slots = nullptr;
+    size_t mask = 0;
+    size_t count = 0;
+    size_t growthLeft = 0;
+    [[no_unique_address]] THash hashFunction;
+    [[no_unique_address]] TEqual equalFunction;
+};
+
+} // namespace hash
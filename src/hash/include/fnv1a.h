@@ -1,11 +1,17 @@
 #pragma once
 
+#include "hash_util.h"
+
+#include <iterator>
 #include <stdint.h>
 #include <string_view>
+#include <type_traits>
 
 namespace hash {
 namespace detail {
-template <typename> struct Fnv1Constants { static_assert(false, "Only 32 and 64 bit unsigned integer supported"); };
+template <typename T> struct Fnv1Constants {
+    static_assert(sizeof(T) == 0, "Only 32 and 64 bit unsigned integer supported");
+};
 
 template <> struct Fnv1Constants<uint32_t> {
     static constexpr uint32_t Prime = 0x01000193ul;
@@ -16,12 +22,42 @@ template <> struct Fnv1Constants<uint64_t> {
     static constexpr uint64_t Prime = 0x00000100000001B3ull;
     static constexpr uint64_t Offset = 0xcbf29ce484222325ull;
 };
+
+template <typename T> inline T fnv1aWords(T hash, const uint8_t* data, size_t length) {
+    const uint8_t* const end = data + length;
+
+    for (; end - data >= 8; data += 8) {
+        uint64_t word = detail::load<uint64_t>(data);
+        for (size_t i = 0; i < 8; ++i) {
+            hash ^= static_cast<T>(word & 0xff);
+            hash *= Fnv1Constants<T>::Prime;
+            word >>= 8;
+        }
+    }
+
+    for (; data != end; ++data) {
+        hash ^= static_cast<T>(*data);
+        hash *= Fnv1Constants<T>::Prime;
+    }
+
+    return hash;
+}
+
 } // namespace detail
 
-template <typename T, typename TBegin, typename TEnd> constexpr T fnv1a(const TBegin& begin, const TEnd& end) {
+// A seed other than zero gives a different hash function, which is enough to decorrelate several tables. It does not
+// protect against hash flooding: colliding inputs collide under every seed, use KeyedHasher from siphash.h for that.
+template <typename T, typename TBegin, std::sentinel_for<TBegin> TEnd>
+constexpr T fnv1a(const TBegin& begin, const TEnd& end, T seed = 0) {
     static_assert(sizeof(*begin) == 1, "Iterators must produce single byte values");
 
-    T hash = detail::Fnv1Constants<T>::Offset;
+    T hash = detail::Fnv1Constants<T>::Offset ^ seed;
+
+    if constexpr (detail::ContiguousBytes<TBegin, TEnd>) {
+        if (!std::is_constant_evaluated()) {
+            return detail::fnv1aWords(hash, detail::bytePointer(begin), static_cast<size_t>(end - begin));
+        }
+    }
 
     for (auto iterator = begin; iterator != end; ++iterator) {
         uint8_t byte = static_cast<uint8_t>(*iterator);
@@ -32,8 +68,8 @@ template <typename T, typename TBegin, typename TEnd> constexpr T fnv1a(const TB
     return hash;
 }
 
-template <typename T> constexpr T fnv1a(const std::string_view& stringView) {
-    return fnv1a<T>(stringView.begin(), stringView.end());
+template <typename T> constexpr T fnv1a(const std::string_view& stringView, T seed = 0) {
+    return fnv1a<T>(stringView.begin(), stringView.end(), seed);
 }
 
 } // namespace hash
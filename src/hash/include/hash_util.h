@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#if __has_include("int128.h")
+#include "int128.h"
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CPPUTILS_HASH_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Enables instruction set extensions for a single function so that it can be selected at runtime
+#if defined(__GNUC__) || defined(__clang__)
+#define CPPUTILS_HASH_TARGET(features) __attribute__((target(features)))
+#else
+#define CPPUTILS_HASH_TARGET(features)
+#endif
+
+namespace hash {
+namespace detail {
+
+template <typename TBegin, typename TEnd>
+concept ContiguousBytes = std::contiguous_iterator<TBegin> && std::sized_sentinel_for<TEnd, TBegin> &&
+                          sizeof(std::iter_value_t<TBegin>) == 1;
+
+template <typename T> constexpr T byteSwap(T value) {
+    T result = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        result = (result << 8) | (value & 0xff);
+        value >>= 8;
+    }
+    return result;
+}
+
+// Unaligned little endian load, not usable in constant evaluation
+template <typename T> inline T load(const void* data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = byteSwap(value);
+    }
+    return value;
+}
+
+// Little endian load of the first available bytes, never reading past them. Short tails are assembled from
+// overlapping loads instead of a byte loop.
+template <typename T> inline T loadPartial(const uint8_t* data, size_t available) {
+    if (available >= sizeof(T)) {
+        return load<T>(data);
+    }
+    if constexpr (sizeof(T) == 8) {
+        if (available >= 4) {
+            const T high = load<uint32_t>(data + available - 4);
+            return load<uint32_t>(data) | (high << ((available - 4) * 8));
+        }
+    }
+    if (available == 0) {
+        return 0;
+    }
+    return static_cast<T>(data[0]) | (static_cast<T>(data[available / 2]) << (available / 2 * 8)) |
+           (static_cast<T>(data[available - 1]) << ((available - 1) * 8));
+}
+
+// High half of the 128 bit product
+constexpr uint64_t mulHigh64(uint64_t lhs, uint64_t rhs) {
+#ifdef CPPUTILS_UINT128
+    return static_cast<uint64_t>((static_cast<uint128_t>(lhs) * rhs) >> 64);
+#else
+    const uint64_t loLo = (lhs & 0xffffffff) * (rhs & 0xffffffff);
+    const uint64_t hiLo = (lhs >> 32) * (rhs & 0xffffffff);
+    const uint64_t loHi = (lhs & 0xffffffff) * (rhs >> 32);
+    const uint64_t hiHi = (lhs >> 32) * (rhs >> 32);
+    const uint64_t cross = (loLo >> 32) + (hiLo & 0xffffffff) + loHi;
+    return (hiLo >> 32) + (cross >> 32) + hiHi;
+#endif
+}
+
+// Maps a well mixed 64 bit hash onto [0, range) with a multiply instead of a division
+constexpr uint64_t fastRange(uint64_t hash, uint64_t range) { return mulHigh64(hash, range); }
+
+template <typename TBegin> inline const uint8_t* bytePointer(const TBegin& iterator) {
+    return reinterpret_cast<const uint8_t*>(std::to_address(iterator));
+}
+
+struct CpuFeatures {
+    bool sse42 = false;
+    bool pclmul = false;
+    bool avx2 = false;
+    bool avx512f = false;
+};
+
+inline CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+#ifdef CPPUTILS_HASH_X86
+    unsigned int registers[4] = {};
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuid(reinterpret_cast<int*>(registers), 0);
+    const unsigned int maxLeaf = registers[0];
+    __cpuid(reinterpret_cast<int*>(registers), 1);
+#else
+    const unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+    __cpuid(1, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    features.sse42 = (registers[2] & (1u << 20)) != 0;
+    features.pclmul = (registers[2] & (1u << 1)) != 0;
+
+    // AVX2 also needs the OS to save the upper halves of the vector registers
+    const bool osAvx = (registers[2] & (1u << 27)) != 0 && (registers[2] & (1u << 28)) != 0;
+    if (osAvx && maxLeaf >= 7) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        const bool ymmEnabled = (_xgetbv(0) & 0x6) == 0x6;
+        const bool zmmEnabled = (_xgetbv(0) & 0xe6) == 0xe6;
+        __cpuidex(reinterpret_cast<int*>(registers), 7, 0);
+#else
+        unsigned int xcr0Low = 0;
+        unsigned int xcr0High = 0;
+        __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+        const bool ymmEnabled = (xcr0Low & 0x6) == 0x6;
+        const bool zmmEnabled = (xcr0Low & 0xe6) == 0xe6;
+        __cpuid_count(7, 0, registers[0], registers[1], registers[2], registers[3]);
+#endif
+        features.avx2 = ymmEnabled && (registers[1] & (1u << 5)) != 0;
+        // AVX-512 additionally needs the opmask and upper ZMM state enabled
+        features.avx512f = zmmEnabled && (registers[1] & (1u << 16)) != 0;
+    }
+#endif
+    return features;
+}
+
+// Detected once, safe to call from any thread
+inline const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+// Runs f(begin, end, threadIndex) over contiguous chunks of [0, count), one chunk per thread. Uses fewer threads when
+// there is less than minPerThread work for each.
+template <typename F> void parallelFor(size_t count, unsigned threads, size_t minPerThread, F&& f) {
+    const size_t useful = count / std::max<size_t>(minPerThread, 1);
+    threads = static_cast<unsigned>(std::clamp<size_t>(useful, 1, std::max(threads, 1u)));
+    if (threads == 1) {
+        f(size_t(0), count, 0u);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([&f, count, threads, i] { f(count * i / threads, count * (i + 1) / threads, i); });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace detail
+} // namespace hash
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "hash_util.h"
+#include "murmur.h"
+
+#include <bit>
+#include <concepts>
+#include <memory>
+#include <stdint.h>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if __has_include("int128.h")
+#include "int128.h"
+#endif
+
+#if __has_include("compressed_pair.h")
+#include "compressed_pair.h"
+#endif
+
+namespace hash {
+
+class HashState;
+
+// Customization point of combine. Specialize it for a type as
+//     template <> struct hash::Hasher<Key> {
+//         void operator()(hash::HashState& state, const Key& key) const { state.update(key.id).update(key.name); }
+//     };
+// The primary template covers arithmetic types, 128 bit integers, pointers, strings, InlineString, std::pair,
+// std::tuple, std::array, memory::CompressedPair and trivially copyable types without padding.
+template <typename T> struct Hasher;
+
+// Running state of combine, one murmur block mix per 8 bytes of key. Values are mixed straight from their
+// representation without being serialized into a buffer first.
+class HashState {
+  public:
+    constexpr explicit HashState(uint64_t seed = 0) : hash(seed) {}
+
+    template <typename T> constexpr HashState& update(const T& value) {
+        Hasher<T>{}(*this, value);
+        return *this;
+    }
+
+    constexpr void mix(uint64_t block) {
+        hash = detail::mixHash<uint64_t>(hash, block);
+        ++blocks;
+    }
+
+    // Mixes 8 byte blocks and one partial block for the tail. The size is not mixed, callers hashing variable sized
+    // data mix it themselves.
+    void mixBytes(const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (; size >= 8; bytes += 8, size -= 8) {
+            mix(detail::load<uint64_t>(bytes));
+        }
+        if (size != 0) {
+            mix(detail::loadPartial<uint64_t>(bytes, size));
+        }
+    }
+
+    constexpr uint64_t finish() const { return detail::fmix<uint64_t>(hash ^ blocks); }
+
+  private:
+    uint64_t hash;
+    uint64_t blocks = 0;
+};
+
+namespace detail {
+namespace composite {
+
+template <typename T>
+concept Wide = sizeof(T) == 16 && (std::is_integral_v<T>
+#if defined(CPPUTILS_UINT128)
+                                   || std::same_as<T, uint128_t>
+#endif
+#if defined(CPPUTILS_INT128)
+                                   || std::same_as<T, int128_t>
+#endif
+                                  );
+
+template <typename T>
+concept TupleLike = requires { std::tuple_size<T>::value; };
+
+template <typename T> struct IsCompressedPair : std::false_type {};
+
+#if __has_include("compressed_pair.h")
+template <typename T1, typename T2> struct IsCompressedPair<memory::CompressedPair<T1, T2>> : std::true_type {};
+#endif
+
+template <typename T> constexpr bool AlwaysFalse = false;
+
+} // namespace composite
+} // namespace detail
+
+template <typename T> struct Hasher {
+    constexpr void operator()(HashState& state, const T& value) const {
+        using namespace detail::composite;
+
+        if constexpr (std::is_empty_v<T>) {
+            // Nothing to hash, keeps empty members of CompressedPair and tuples free
+        } else if constexpr (Wide<T>) {
+            state.mix(static_cast<uint64_t>(value));
+            state.mix(static_cast<uint64_t>(value >> 64));
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            state.mix(static_cast<uint64_t>(value));
+        } else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            // Zero and negative zero compare equal, so they hash the same
+            using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+            state.mix(value == 0 ? 0 : std::bit_cast<Bits>(value));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            // Also covers std::string and str::InlineString
+            const std::string_view string = value;
+            state.mix(string.size());
+            state.mixBytes(string.data(), string.size());
+        } else if constexpr (std::is_pointer_v<T>) {
+            state.mix(reinterpret_cast<uintptr_t>(value));
+        } else if constexpr (IsCompressedPair<T>::value) {
+            state.update(value.first()).update(value.second());
+        } else if constexpr (TupleLike<T>) {
+            // Before the raw bytes, so std::array{1, 2} hashes like std::pair(1, 2) and combine(1, 2)
+            std::apply([&](const auto&... elements) { (state.update(elements), ...); }, value);
+        } else if constexpr (std::has_unique_object_representations_v<T>) {
+            // Structs without padding and arrays of them hash their bytes in one go
+            state.mixBytes(std::addressof(value), sizeof(T));
+        } else {
+            static_assert(AlwaysFalse<T>, "Specialize hash::Hasher for this type");
+        }
+    }
+};
+
+// 64 bit hash of all values together, for composite keys such as the columns of a group by. The values are mixed
+// one after another in a single pass, which is both faster and better distributed than chaining std::hash results.
+// The result depends on the order of the values, and in some cases on the byte order of the platform.
+template <typename... Ts> constexpr uint64_t combine(const Ts&... values) {
+    HashState state;
+    (state.update(values), ...);
+    return state.finish();
+}
+
+// Hash functor for containers, hashing the key with combine
+struct CompositeHasher {
+    template <typename T> size_t operator()(const T& value) const { return static_cast<size_t>(combine(value)); }
+};
+
+} // namespace hash
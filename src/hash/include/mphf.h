@@ -0,0 +1,312 @@
+#pragma once
+
+#include "hash_util.h"
+#include "murmur.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <stdint.h>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace hash {
+namespace detail {
+namespace mphf {
+
+// "MPHF" and the format version, also tells apart blobs written with the other byte order
+constexpr uint64_t Magic = 0x4650484d00000001ull;
+
+constexpr size_t MaxLevels = 32;
+
+// Header words, followed by an offset and size in bits per level
+constexpr size_t HeaderMagic = 0;
+constexpr size_t HeaderKeyCount = 1;
+constexpr size_t HeaderSeed = 2;
+constexpr size_t HeaderLevelCount = 3;
+constexpr size_t HeaderBitWords = 4;
+constexpr size_t HeaderFallbackCount = 5;
+constexpr size_t HeaderSize = 6;
+
+// One cumulative rank per block of words
+constexpr size_t RankBlockWords = 8;
+
+struct KeyHash {
+    uint64_t low;
+    uint64_t high;
+
+    friend constexpr bool operator==(const KeyHash&, const KeyHash&) = default;
+    friend constexpr auto operator<=>(const KeyHash&, const KeyHash&) = default;
+};
+
+inline KeyHash hashKey(std::string_view key, uint64_t seed) {
+    const auto [low, high] = detail::murmurHash3x64(key.begin(), key.end(), seed);
+    return {low, high | 1};
+}
+
+// Each level derives its own position from the one 128 bit key hash
+constexpr uint64_t levelPosition(const KeyHash& hash, size_t level, uint64_t levelBits) {
+    return fastRange(detail::fmix(hash.low + level * hash.high), levelBits);
+}
+
+} // namespace mphf
+} // namespace detail
+
+struct MphfOptions {
+    // Bits per key and level, lower values give smaller functions at the cost of more levels to build and probe.
+    // 1.0 ends up at about 3 bits per key.
+    double gamma = 1.0;
+    // Zero uses every hardware thread
+    unsigned threads = 0;
+    uint64_t seed = 0;
+};
+
+// Read only view of a serialized minimal perfect hash function, for example straight from a memory mapped file. The
+// words have to stay alive and unchanged while the view is in use.
+class MinimalPerfectHashView {
+  public:
+    MinimalPerfectHashView() = default;
+
+    explicit MinimalPerfectHashView(std::span<const uint64_t> words) {
+        using namespace detail::mphf;
+
+        if (words.size() < HeaderSize || words[HeaderMagic] != Magic) {
+            throw std::invalid_argument("Not a minimal perfect hash blob");
+        }
+
+        keyCount = words[HeaderKeyCount];
+        seed = words[HeaderSeed];
+        levelCount = words[HeaderLevelCount];
+        const uint64_t bitWords = words[HeaderBitWords];
+        fallbackCount = words[HeaderFallbackCount];
+
+        // Bounding the counts by the blob size first keeps the size sum from wrapping around
+        const uint64_t rankWords = (bitWords + RankBlockWords - 1) / RankBlockWords;
+        if (levelCount > MaxLevels || bitWords > words.size() || fallbackCount > words.size() ||
+            words.size() != HeaderSize + 2 * levelCount + bitWords + rankWords + 2 * fallbackCount) {
+            throw std::invalid_argument("Truncated minimal perfect hash blob");
+        }
+
+        // Lookups index the bits with the level ranges unchecked, so every range has to lie within them
+        levels = words.data() + HeaderSize;
+        const uint64_t totalBits = bitWords * 64;
+        for (size_t level = 0; level < levelCount; ++level) {
+            const uint64_t offset = levels[2 * level];
+            const uint64_t size = levels[2 * level + 1];
+            if (size == 0 || size > totalBits || offset > totalBits - size) {
+                throw std::invalid_argument("Minimal perfect hash level out of bounds");
+            }
+        }
+        if (fallbackCount > keyCount) {
+            throw std::invalid_argument("Minimal perfect hash has more fallback keys than keys");
+        }
+
+        bits = levels + 2 * levelCount;
+        ranks = bits + bitWords;
+        fallback = ranks + rankWords;
+    }
+
+    // Position of the key in [0, size()). Keys outside the original set map to arbitrary positions.
+    size_t operator()(std::string_view key) const {
+        using namespace detail::mphf;
+
+        const KeyHash hash = hashKey(key, seed);
+
+        for (size_t level = 0; level < levelCount; ++level) {
+            const uint64_t position = levels[2 * level] + levelPosition(hash, level, levels[2 * level + 1]);
+            const uint64_t word = bits[position / 64];
+            const uint64_t bit = uint64_t(1) << (position % 64);
+            if (word & bit) {
+                return static_cast<size_t>(rank(position));
+            }
+        }
+
+        if (fallbackCount == 0) {
+            return 0;
+        }
+
+        // Keys that no level could place, sorted by hash
+        size_t low = 0;
+        size_t high = static_cast<size_t>(fallbackCount);
+        while (low < high) {
+            const size_t middle = low + (high - low) / 2;
+            const KeyHash candidate{fallback[2 * middle], fallback[2 * middle + 1]};
+            if (candidate < hash) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return static_cast<size_t>(keyCount - fallbackCount + std::min<size_t>(low, fallbackCount - 1));
+    }
+
+    size_t size() const { return static_cast<size_t>(keyCount); }
+
+  private:
+    uint64_t rank(uint64_t position) const {
+        using detail::mphf::RankBlockWords;
+
+        const uint64_t wordIndex = position / 64;
+        const uint64_t blockStart = wordIndex / RankBlockWords * RankBlockWords;
+
+        uint64_t result = ranks[wordIndex / RankBlockWords];
+        for (uint64_t i = blockStart; i < wordIndex; ++i) {
+            result += static_cast<uint64_t>(std::popcount(bits[i]));
+        }
+        const uint64_t below = (uint64_t(1) << (position % 64)) - 1;
+        return result + static_cast<uint64_t>(std::popcount(bits[wordIndex] & below));
+    }
+
+  private:
+    uint64_t keyCount = 0;
+    uint64_t seed = 0;
+    uint64_t levelCount = 0;
+    uint64_t fallbackCount = 0;
+    const uint64_t* levels = nullptr;
+    const uint64_t* bits = nullptr;
+    const uint64_t* ranks = nullptr;
+    const uint64_t* fallback = nullptr;
+};
+
+// Minimal perfect hash function owning its serialized form. words() is what gets written to disk, and either the
+// constructor or MinimalPerfectHashView reads it back.
+class MinimalPerfectHash {
+  public:
+    MinimalPerfectHash() = default;
+
+    explicit MinimalPerfectHash(std::vector<uint64_t> words) : storage(std::move(words)), view(storage) {}
+
+    MinimalPerfectHash(const MinimalPerfectHash& other) : storage(other.storage) { rebind(); }
+    MinimalPerfectHash(MinimalPerfectHash&& other) noexcept = default;
+
+    MinimalPerfectHash& operator=(const MinimalPerfectHash& other) {
+        storage = other.storage;
+        rebind();
+        return *this;
+    }
+    MinimalPerfectHash& operator=(MinimalPerfectHash&& other) noexcept = default;
+
+    size_t operator()(std::string_view key) const { return view(key); }
+
+    size_t size() const { return view.size(); }
+
+    std::span<const uint64_t> words() const { return storage; }
+
+  private:
+    void rebind() { view = storage.empty() ? MinimalPerfectHashView() : MinimalPerfectHashView(storage); }
+
+  private:
+    std::vector<uint64_t> storage;
+    MinimalPerfectHashView view;
+};
+
+// Builds a minimal perfect hash function in the style of BBHash. Every level gives each remaining key a bit in an
+// array of gamma bits per key, keys that got a bit to themselves are done and the rest move on to the next level.
+// The levels are filled in parallel with atomic bit operations. Throws std::invalid_argument for duplicate keys.
+template <std::ranges::random_access_range TKeys>
+    requires std::convertible_to<std::ranges::range_reference_t<TKeys>, std::string_view>
+MinimalPerfectHash buildMinimalPerfectHash(const TKeys& keys, const MphfOptions& options = {}) {
+    using namespace detail::mphf;
+
+    const size_t keyCount = static_cast<size_t>(std::ranges::size(keys));
+    const unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<KeyHash> remaining(keyCount);
+    detail::parallelFor(keyCount, threads, 4096, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            remaining[i] = hashKey(std::string_view(std::ranges::begin(keys)[i]), options.seed);
+        }
+    });
+
+    std::vector<uint64_t> levels;
+    std::vector<uint64_t> bits;
+    std::vector<uint64_t> collisions;
+
+    for (size_t level = 0; level < MaxLevels && !remaining.empty(); ++level) {
+        const uint64_t levelWords = std::max<uint64_t>(
+            1, static_cast<uint64_t>(std::ceil(options.gamma * static_cast<double>(remaining.size()) / 64)));
+        const uint64_t levelBits = levelWords * 64;
+        const size_t levelStart = bits.size();
+
+        levels.push_back(levelStart * 64);
+        levels.push_back(levelBits);
+        bits.resize(levelStart + levelWords, 0);
+        collisions.assign(levelWords, 0);
+
+        uint64_t* levelData = bits.data() + levelStart;
+        detail::parallelFor(remaining.size(), threads, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint64_t position = levelPosition(remaining[i], level, levelBits);
+                const uint64_t bit = uint64_t(1) << (position % 64);
+                const uint64_t previous =
+                    std::atomic_ref<uint64_t>(levelData[position / 64]).fetch_or(bit, std::memory_order_relaxed);
+                if (previous & bit) {
+                    std::atomic_ref<uint64_t>(collisions[position / 64]).fetch_or(bit, std::memory_order_relaxed);
+                }
+            }
+        });
+
+        for (uint64_t i = 0; i < levelWords; ++i) {
+            levelData[i] &= ~collisions[i];
+        }
+
+        // Keep the colliding keys in their original order, so the result does not depend on the thread count
+        std::vector<std::vector<KeyHash>> next(threads);
+        detail::parallelFor(remaining.size(), threads, 4096, [&](size_t begin, size_t end, unsigned thread) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint64_t position = levelPosition(remaining[i], level, levelBits);
+                if (collisions[position / 64] & (uint64_t(1) << (position % 64))) {
+                    next[thread].push_back(remaining[i]);
+                }
+            }
+        });
+
+        remaining.clear();
+        for (const std::vector<KeyHash>& part : next) {
+            remaining.insert(remaining.end(), part.begin(), part.end());
+        }
+    }
+
+    std::sort(remaining.begin(), remaining.end());
+    if (std::adjacent_find(remaining.begin(), remaining.end()) != remaining.end()) {
+        throw std::invalid_argument("Minimal perfect hash keys must be unique");
+    }
+
+    const size_t rankWords = (bits.size() + RankBlockWords - 1) / RankBlockWords;
+
+    std::vector<uint64_t> words;
+    words.reserve(HeaderSize + levels.size() + bits.size() + rankWords + 2 * remaining.size());
+    words.resize(HeaderSize);
+    words[HeaderMagic] = Magic;
+    words[HeaderKeyCount] = keyCount;
+    words[HeaderSeed] = options.seed;
+    words[HeaderLevelCount] = levels.size() / 2;
+    words[HeaderBitWords] = bits.size();
+    words[HeaderFallbackCount] = remaining.size();
+
+    words.insert(words.end(), levels.begin(), levels.end());
+    words.insert(words.end(), bits.begin(), bits.end());
+
+    uint64_t rank = 0;
+    for (size_t i = 0; i < bits.size(); ++i) {
+        if (i % RankBlockWords == 0) {
+            words.push_back(rank);
+        }
+        rank += static_cast<uint64_t>(std::popcount(bits[i]));
+    }
+
+    for (const KeyHash& hash : remaining) {
+        words.push_back(hash.low);
+        words.push_back(hash.high);
+    }
+
+    return MinimalPerfectHash(std::move(words));
+}
+
+} // namespace hash
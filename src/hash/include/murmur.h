@@ -1,11 +1,23 @@
+#pragma once
+
+#include "hash_util.h"
 
 #include <iterator>
+#include <span>
 #include <stdint.h>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if __has_include("int128.h")
+#include "int128.h"
+#endif
 
 namespace hash {
 namespace detail {
-template <typename> struct MurmurConstants { static_assert(false, "Only 32 and 64 bit unsigned integer supported"); };
+template <typename T> struct MurmurConstants {
+    static_assert(sizeof(T) == 0, "Only 32 and 64 bit unsigned integer supported");
+};
 
 template <> struct MurmurConstants<uint32_t> {
     static constexpr int8_t MixShiftA = 16;
@@ -30,9 +42,14 @@ template <> struct MurmurConstants<uint64_t> {
 
     static constexpr int8_t Rotate1 = 31;
     static constexpr int8_t Rotate2 = 27;
-    static constexpr uint32_t Constant1 = 0x87c37b91114253d5ull;
-    static constexpr uint32_t Constant2 = 0x4cf5ad432745937full;
-    static constexpr uint32_t Constant3 = 0x52dce729ull;
+    static constexpr uint64_t Constant1 = 0x87c37b91114253d5ull;
+    static constexpr uint64_t Constant2 = 0x4cf5ad432745937full;
+    static constexpr uint64_t Constant3 = 0x52dce729ull;
+
+    // Second lane of MurmurHash3_x64_128
+    static constexpr int8_t Rotate3 = 33;
+    static constexpr int8_t Rotate4 = 31;
+    static constexpr uint64_t Constant4 = 0x38495ab5ull;
 };
 
 template <typename T> constexpr T rotl(T value, int8_t count) {
@@ -50,60 +67,239 @@ template <typename T> constexpr T fmix(T value) {
     return value;
 }
 
-} // namespace detail
+template <typename T> constexpr T mixBlock(T block) {
+    using Constants = detail::MurmurConstants<T>;
 
-template <typename T, typename TBegin, typename TEnd>
-constexpr T murmurHash3(const TBegin& begin, const TEnd& end, T seed = 0) {
-    static_assert(sizeof(*begin) == 1, "Iterators must produce single byte values");
+    block *= Constants::Constant1;
+    block = detail::rotl(block, Constants::Rotate1);
+    block *= Constants::Constant2;
+    return block;
+}
 
+template <typename T> constexpr T mixHash(T hash, T block) {
     using Constants = detail::MurmurConstants<T>;
-    constexpr size_t BlockSize = sizeof(T);
 
-    const size_t length = std::distance(begin, end);
-    const size_t blockCount = length / BlockSize;
+    hash ^= mixBlock(block);
+    hash = detail::rotl(hash, Constants::Rotate2);
+    hash = hash * 5 + Constants::Constant3;
+    return hash;
+}
+
+constexpr uint64_t mixBlock2(uint64_t block) {
+    using Constants = detail::MurmurConstants<uint64_t>;
+
+    block *= Constants::Constant2;
+    block = detail::rotl(block, Constants::Rotate3);
+    block *= Constants::Constant1;
+    return block;
+}
+
+template <typename TBegin, typename TEnd>
+constexpr std::pair<uint64_t, uint64_t> murmurHash3x64(const TBegin& begin, const TEnd& end, uint64_t seed) {
+    static_assert(sizeof(*begin) == 1, "Iterators must produce single byte values");
+
+    using Constants = detail::MurmurConstants<uint64_t>;
+    constexpr size_t BlockSize = 16;
+
+    uint64_t hash1 = seed;
+    uint64_t hash2 = seed;
+    size_t length = 0;
 
-    T hash = seed;
     auto iterator = begin;
 
-    for (size_t i = 0; i < blockCount; ++i) {
-        T block = 0;
-        for (size_t j = 0; j < BlockSize; ++j) {
+    if constexpr (detail::ContiguousBytes<TBegin, TEnd>) {
+        if (!std::is_constant_evaluated()) {
+            const uint8_t* data = detail::bytePointer(begin);
+            const size_t blockCount = static_cast<size_t>(end - begin) / BlockSize;
+
+            for (size_t i = 0; i < blockCount; ++i, data += BlockSize) {
+                hash1 ^= mixBlock(detail::load<uint64_t>(data));
+                hash1 = detail::rotl(hash1, Constants::Rotate2);
+                hash1 += hash2;
+                hash1 = hash1 * 5 + Constants::Constant3;
+
+                hash2 ^= mixBlock2(detail::load<uint64_t>(data + 8));
+                hash2 = detail::rotl(hash2, Constants::Rotate4);
+                hash2 += hash1;
+                hash2 = hash2 * 5 + Constants::Constant4;
+            }
+
+            const size_t remaining = static_cast<size_t>(end - begin) - blockCount * BlockSize;
+            if (remaining > 8) {
+                hash2 ^= mixBlock2(detail::loadPartial<uint64_t>(data + 8, remaining - 8));
+            }
+            if (remaining != 0) {
+                hash1 ^= mixBlock(detail::loadPartial<uint64_t>(data, remaining));
+            }
+
+            length = static_cast<size_t>(end - begin);
+            iterator += static_cast<std::iter_difference_t<TBegin>>(length);
+        }
+    }
+
+    while (iterator != end) {
+        uint64_t block1 = 0;
+        uint64_t block2 = 0;
+        size_t j = 0;
+        for (; j < BlockSize && iterator != end; ++j, ++iterator) {
             uint8_t byte = static_cast<uint8_t>(*iterator);
+            if (j < 8) {
+                block1 |= static_cast<uint64_t>(byte) << (j * 8);
+            } else {
+                block2 |= static_cast<uint64_t>(byte) << ((j - 8) * 8);
+            }
+        }
+        length += j;
+
+        if (j == BlockSize) {
+            hash1 ^= mixBlock(block1);
+            hash1 = detail::rotl(hash1, Constants::Rotate2);
+            hash1 += hash2;
+            hash1 = hash1 * 5 + Constants::Constant3;
+
+            hash2 ^= mixBlock2(block2);
+            hash2 = detail::rotl(hash2, Constants::Rotate4);
+            hash2 += hash1;
+            hash2 = hash2 * 5 + Constants::Constant4;
+        } else {
+            if (j > 8) {
+                hash2 ^= mixBlock2(block2);
+            }
+            hash1 ^= mixBlock(block1);
+        }
+    }
+
+    hash1 ^= static_cast<uint64_t>(length);
+    hash2 ^= static_cast<uint64_t>(length);
+
+    hash1 += hash2;
+    hash2 += hash1;
+
+    hash1 = detail::fmix(hash1);
+    hash2 = detail::fmix(hash2);
+
+    hash1 += hash2;
+    hash2 += hash1;
+
+    return {hash1, hash2};
+}
+
+} // namespace detail
+
+// Incremental MurmurHash3, producing the same result as murmurHash3 over the concatenation of all updates.
+template <typename T> class MurmurHasher {
+  private:
+    static constexpr size_t BlockSize = sizeof(T);
+
+  public:
+    constexpr explicit MurmurHasher(T seed = 0) : hash(seed) {}
+
+    template <typename TBegin, typename TEnd> constexpr MurmurHasher& update(const TBegin& begin, const TEnd& end) {
+        static_assert(sizeof(*begin) == 1, "Iterators must produce single byte values");
+
+        auto iterator = begin;
+
+        while (tailLength != 0 && iterator != end) {
+            appendTail(static_cast<uint8_t>(*iterator));
             ++iterator;
-            block |= static_cast<T>(byte) << (j * 8);
         }
 
-        block *= Constants::Constant1;
-        block = detail::rotl(block, Constants::Rotate1);
-        block *= Constants::Constant2;
+        if constexpr (detail::ContiguousBytes<TBegin, TEnd>) {
+            if (!std::is_constant_evaluated()) {
+                const uint8_t* data = detail::bytePointer(iterator);
+                const size_t blockCount = static_cast<size_t>(end - iterator) / BlockSize;
+
+                for (size_t i = 0; i < blockCount; ++i, data += BlockSize) {
+                    hash = detail::mixHash(hash, detail::load<T>(data));
+                }
+
+                length += blockCount * BlockSize;
+                iterator += static_cast<std::iter_difference_t<TBegin>>(blockCount * BlockSize);
+            }
+        }
+
+        while (iterator != end) {
+            T block = 0;
+            size_t j = 0;
+            for (; j < BlockSize && iterator != end; ++j, ++iterator) {
+                uint8_t byte = static_cast<uint8_t>(*iterator);
+                block |= static_cast<T>(byte) << (j * 8);
+            }
+
+            if (j == BlockSize) {
+                hash = detail::mixHash(hash, block);
+                length += BlockSize;
+            } else {
+                tail = block;
+                tailLength = static_cast<uint8_t>(j);
+                length += j;
+            }
+        }
 
-        hash ^= block;
-        hash = detail::rotl(hash, Constants::Rotate2);
-        hash = hash * 5 + Constants::Constant3;
+        return *this;
     }
 
-    if (iterator != end) {
-        T block = 0;
-        for (size_t offset = 0; iterator != end; ++iterator, offset += 8) {
-            uint8_t byte = static_cast<uint8_t>(*iterator);
-            block ^= static_cast<T>(byte) << offset;
+    template <typename TByte, size_t Extent> constexpr MurmurHasher& update(std::span<TByte, Extent> data) {
+        return update(data.begin(), data.end());
+    }
+
+    constexpr MurmurHasher& update(const std::string_view& stringView) {
+        return update(stringView.begin(), stringView.end());
+    }
+
+    constexpr T finalize() const {
+        T result = hash;
+
+        if (tailLength != 0) {
+            result ^= detail::mixBlock(tail);
         }
 
-        block *= Constants::Constant1;
-        block = detail::rotl(block, Constants::Rotate1);
-        block *= Constants::Constant2;
+        result ^= static_cast<T>(length);
+        return detail::fmix(result);
+    }
+
+    constexpr void reset(T seed = 0) { *this = MurmurHasher(seed); }
 
-        hash ^= block;
+  private:
+    constexpr void appendTail(uint8_t byte) {
+        tail |= static_cast<T>(byte) << (tailLength * 8);
+        ++tailLength;
+        ++length;
+
+        if (tailLength == BlockSize) {
+            hash = detail::mixHash(hash, tail);
+            tail = 0;
+            tailLength = 0;
+        }
     }
 
-    hash ^= static_cast<T>(length);
-    hash = detail::fmix(hash);
+  private:
+    T hash;
+    T tail = 0;
+    uint8_t tailLength = 0;
+    size_t length = 0;
+};
 
-    return hash;
+template <typename T, typename TBegin, typename TEnd>
+constexpr T murmurHash3(const TBegin& begin, const TEnd& end, T seed = 0) {
+    return MurmurHasher<T>(seed).update(begin, end).finalize();
 }
 
 inline constexpr uint32_t murmurHash3(const std::string_view& stringView, const uint32_t seed = 0) {
     return murmurHash3<uint32_t>(stringView.begin(), stringView.end(), seed);
 }
 
+#ifdef CPPUTILS_UINT128
+// MurmurHash3_x64_128, with the first 64 bit lane in the low half of the result
+template <typename TBegin, std::sentinel_for<TBegin> TEnd>
+constexpr uint128_t murmurHash3_128(const TBegin& begin, const TEnd& end, uint64_t seed = 0) {
+    const auto [low, high] = detail::murmurHash3x64(begin, end, seed);
+    return static_cast<uint128_t>(low) | (static_cast<uint128_t>(high) << 64);
+}
+
+inline constexpr uint128_t murmurHash3_128(const std::string_view& stringView, uint64_t seed = 0) {
+    return murmurHash3_128(stringView.begin(), stringView.end(), seed);
+}
+#endif
+
 } // namespace hash
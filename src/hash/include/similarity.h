@@ -0,0 +1,223 @@
+#pragma once
+
+#include "flat_hash_map.h"
+#include "hash_util.h"
+#include "murmur.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+
+namespace hash {
+namespace detail {
+namespace similarity {
+
+inline uint64_t hashKey(std::string_view key, uint64_t seed) {
+    return detail::murmurHash3x64(key.begin(), key.end(), seed).first;
+}
+
+constexpr uint64_t EmptyBin = std::numeric_limits<uint64_t>::max();
+
+} // namespace similarity
+} // namespace detail
+
+// MinHash signature with one permutation hashing: every feature is hashed once, the hash picks a bin and each bin
+// keeps the smallest hash it saw, so building a signature costs one hash per feature instead of one per bin. Empty
+// bins are filled by optimal densification (Shrivastava 2017), which borrows the value of a non-empty bin chosen by a
+// fixed random probe sequence per bin, so equal bins still estimate Jaccard similarity. Signatures are comparable when
+// they come from the same bin count and seed.
+class MinHash {
+  public:
+    explicit MinHash(size_t bins = 128, uint64_t seed = 0)
+        : seed(seed), mins(bins, detail::similarity::EmptyBin) {
+        if (bins == 0 || bins > std::numeric_limits<uint32_t>::max()) {
+            throw std::invalid_argument("MinHash needs between 1 and 2^32 - 1 bins");
+        }
+    }
+
+    void insert(std::string_view feature) { insertHash(detail::similarity::hashKey(feature, seed)); }
+
+    // Inserts an already hashed feature, the hash has to be uniform over all 64 bits
+    void insertHash(uint64_t hash) {
+        uint64_t& bin = mins[detail::fastRange(hash, mins.size())];
+        bin = std::min(bin, hash);
+    }
+
+    // Densified signature with one value per bin. A signature of an empty set has every value set to the maximum.
+    std::vector<uint64_t> signature() const {
+        std::vector<uint64_t> result = mins;
+        const size_t empty = static_cast<size_t>(std::count(mins.begin(), mins.end(), detail::similarity::EmptyBin));
+        if (empty == 0 || empty == mins.size()) {
+            return result;
+        }
+
+        const uint64_t probeSeed = detail::fmix<uint64_t>(seed ^ 0x64656e7369667900ull);
+        for (size_t i = 0; i < mins.size(); ++i) {
+            if (mins[i] != detail::similarity::EmptyBin) {
+                continue;
+            }
+            for (uint64_t attempt = 1;; ++attempt) {
+                const uint64_t probe = detail::fmix<uint64_t>(probeSeed ^ (uint64_t(i) << 32 | attempt));
+                const uint64_t candidate = mins[detail::fastRange(probe, mins.size())];
+                if (candidate != detail::similarity::EmptyBin) {
+                    result[i] = candidate;
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    void clear() { std::fill(mins.begin(), mins.end(), detail::similarity::EmptyBin); }
+
+    size_t bins() const { return mins.size(); }
+
+  private:
+    uint64_t seed;
+    std::vector<uint64_t> mins;
+};
+
+// Fraction of equal positions, an unbiased estimate of the Jaccard similarity of the two feature sets
+inline double jaccardEstimate(std::span<const uint64_t> lhs, std::span<const uint64_t> rhs) {
+    if (lhs.size() != rhs.size() || lhs.empty()) {
+        throw std::invalid_argument("MinHash signatures must have the same, non-zero length");
+    }
+
+    size_t equal = 0;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        equal += lhs[i] == rhs[i] ? 1 : 0;
+    }
+    return static_cast<double>(equal) / static_cast<double>(lhs.size());
+}
+
+// 64 bit SimHash (Charikar): every feature adds its weight to the bits set in its hash and subtracts it from the
+// others, and the fingerprint keeps the sign of each sum. The Hamming distance of two fingerprints tracks the cosine
+// distance of the weighted feature vectors.
+class SimHash {
+  public:
+    explicit SimHash(uint64_t seed = 0) : seed(seed) {}
+
+    void insert(std::string_view feature, int64_t weight = 1) {
+        insertHash(detail::similarity::hashKey(feature, seed), weight);
+    }
+
+    void insertHash(uint64_t hash, int64_t weight = 1) {
+        // Branch free so the compiler can vectorize the 64 counters
+        for (size_t bit = 0; bit < 64; ++bit) {
+            const int64_t sign = static_cast<int64_t>((hash >> bit) & 1) * 2 - 1;
+            counts[bit] += sign * weight;
+        }
+    }
+
+    uint64_t value() const {
+        uint64_t fingerprint = 0;
+        for (size_t bit = 0; bit < 64; ++bit) {
+            fingerprint |= static_cast<uint64_t>(counts[bit] > 0) << bit;
+        }
+        return fingerprint;
+    }
+
+    void clear() { counts.fill(0); }
+
+  private:
+    uint64_t seed;
+    std::array<int64_t, 64> counts{};
+};
+
+constexpr unsigned hammingDistance(uint64_t lhs, uint64_t rhs) {
+    return static_cast<unsigned>(std::popcount(lhs ^ rhs));
+}
+
+// Locality sensitive hashing index over MinHash signatures. A signature is cut into bands of rows values and every band
+// is hashed into its own table, two signatures become candidates when at least one band matches. Pairs with Jaccard
+// similarity s collide with probability 1 - (1 - s^rows)^bands, a steep curve around threshold().
+class LshIndex {
+  public:
+    LshIndex(size_t bands, size_t rows) : rows(rows), tables(bands) {
+        if (bands == 0 || rows == 0) {
+            throw std::invalid_argument("LshIndex needs at least one band and one row");
+        }
+    }
+
+    // Adds the signature under the id, the same id may be inserted more than once
+    void insert(uint64_t id, std::span<const uint64_t> signature) {
+        checkLength(signature);
+
+        if ((ids.size() + 1) * tables.size() >= NoEntry) {
+            throw std::length_error("LshIndex is full");
+        }
+        ids.push_back(id);
+
+        for (size_t band = 0; band < tables.size(); ++band) {
+            // Entries sharing a bucket form a linked list through next, newest first
+            const auto position = tables[band].tryEmplace(bandHash(signature, band), NoEntry).first;
+            next.push_back(position->second);
+            position->second = static_cast<uint32_t>(next.size() - 1);
+        }
+    }
+
+    // Calls onCandidate(uint64_t id) for every entry sharing a band with the signature, an id is reported once per
+    // matching band
+    template <typename F> void forEachCandidate(std::span<const uint64_t> signature, F&& onCandidate) const {
+        checkLength(signature);
+
+        for (size_t band = 0; band < tables.size(); ++band) {
+            const auto position = tables[band].find(bandHash(signature, band));
+            if (position == tables[band].end()) {
+                continue;
+            }
+            for (uint32_t link = position->second; link != NoEntry; link = next[link]) {
+                onCandidate(ids[link / tables.size()]);
+            }
+        }
+    }
+
+    // Candidate ids, sorted and without duplicates
+    std::vector<uint64_t> candidates(std::span<const uint64_t> signature) const {
+        std::vector<uint64_t> result;
+        forEachCandidate(signature, [&](uint64_t id) { result.push_back(id); });
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    // Similarity at which the collision probability rises most steeply, roughly where it crosses one half
+    double threshold() const {
+        return std::pow(1.0 / static_cast<double>(tables.size()), 1.0 / static_cast<double>(rows));
+    }
+
+    size_t bands() const { return tables.size(); }
+    size_t size() const { return ids.size(); }
+
+  private:
+    static constexpr uint32_t NoEntry = std::numeric_limits<uint32_t>::max();
+
+    void checkLength(std::span<const uint64_t> signature) const {
+        if (signature.size() != tables.size() * rows) {
+            throw std::invalid_argument("Signature length must be bands * rows");
+        }
+    }
+
+    uint64_t bandHash(std::span<const uint64_t> signature, size_t band) const {
+        const auto bytes = std::as_bytes(signature.subspan(band * rows, rows));
+        const auto* data = reinterpret_cast<const uint8_t*>(bytes.data());
+        return detail::murmurHash3x64(data, data + bytes.size(), band).first;
+    }
+
+  private:
+    size_t rows;
+    // Per band, the newest link of every bucket
+    std::vector<FlatHashMap<uint64_t, uint32_t>> tables;
+    std::vector<uint64_t> ids;
+    // One link per entry and band, link / bands is the entry
+    std::vector<uint32_t> next;
+};
+
+} // namespace hash
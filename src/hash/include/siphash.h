@@ -0,0 +1,181 @@
+#pragma once
+
+#include "hash_util.h"
+
+#include <chrono>
+#include <concepts>
+#include <iterator>
+#include <random>
+#include <stdint.h>
+#include <string_view>
+#include <type_traits>
+
+namespace hash {
+
+// 128 bit SipHash key
+struct SipKey {
+    uint64_t k0 = 0;
+    uint64_t k1 = 0;
+
+    friend constexpr bool operator==(const SipKey&, const SipKey&) = default;
+};
+
+namespace detail {
+
+class SipState {
+  public:
+    constexpr explicit SipState(const SipKey& key)
+        : v0(key.k0 ^ 0x736f6d6570736575ull), v1(key.k1 ^ 0x646f72616e646f6dull), v2(key.k0 ^ 0x6c7967656e657261ull),
+          v3(key.k1 ^ 0x7465646279746573ull) {}
+
+    template <int Rounds> constexpr void compress(uint64_t block) {
+        v3 ^= block;
+        rounds<Rounds>();
+        v0 ^= block;
+    }
+
+    template <int CompressionRounds, int FinalizationRounds> constexpr uint64_t finish(uint64_t lastBlock) {
+        compress<CompressionRounds>(lastBlock);
+        v2 ^= 0xff;
+        rounds<FinalizationRounds>();
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+
+  private:
+    static constexpr uint64_t rotl(uint64_t value, int count) { return (value << count) | (value >> (64 - count)); }
+
+    template <int Rounds> constexpr void rounds() {
+        for (int i = 0; i < Rounds; ++i) {
+            v0 += v1;
+            v1 = rotl(v1, 13);
+            v1 ^= v0;
+            v0 = rotl(v0, 32);
+            v2 += v3;
+            v3 = rotl(v3, 16);
+            v3 ^= v2;
+            v0 += v3;
+            v3 = rotl(v3, 21);
+            v3 ^= v0;
+            v2 += v1;
+            v1 = rotl(v1, 17);
+            v1 ^= v2;
+            v2 = rotl(v2, 32);
+        }
+    }
+
+  private:
+    uint64_t v0;
+    uint64_t v1;
+    uint64_t v2;
+    uint64_t v3;
+};
+
+// SipHash-c-d, the finalization round count picks the variant: 1-3 or 2-4
+template <int CompressionRounds, int FinalizationRounds, typename TBegin, typename TEnd>
+constexpr uint64_t sipHash(const TBegin& begin, const TEnd& end, const SipKey& key) {
+    static_assert(sizeof(*begin) == 1, "Iterators must produce single byte values");
+
+    SipState state(key);
+    size_t length = 0;
+
+    auto iterator = begin;
+
+    if constexpr (detail::ContiguousBytes<TBegin, TEnd>) {
+        if (!std::is_constant_evaluated()) {
+            const uint8_t* data = detail::bytePointer(begin);
+            length = static_cast<size_t>(end - begin);
+
+            size_t remaining = length;
+            for (; remaining >= 8; data += 8, remaining -= 8) {
+                state.compress<CompressionRounds>(detail::load<uint64_t>(data));
+            }
+
+            const uint64_t last =
+                detail::loadPartial<uint64_t>(data, remaining) | (static_cast<uint64_t>(length) << 56);
+            return state.finish<CompressionRounds, FinalizationRounds>(last);
+        }
+    }
+
+    uint64_t block = 0;
+    for (; iterator != end; ++iterator, ++length) {
+        block |= static_cast<uint64_t>(static_cast<uint8_t>(*iterator)) << ((length % 8) * 8);
+        if (length % 8 == 7) {
+            state.compress<CompressionRounds>(block);
+            block = 0;
+        }
+    }
+
+    return state.finish<CompressionRounds, FinalizationRounds>(block | (static_cast<uint64_t>(length) << 56));
+}
+
+// Seeds from the OS where possible, mixed with the clock and an address in case random_device is deterministic
+inline SipKey randomSipKey() {
+    std::random_device device;
+    const auto next = [&device] { return (static_cast<uint64_t>(device()) << 32) ^ device(); };
+
+    const uint64_t clock = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    const uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&device));
+
+    SipState mixer(SipKey{next(), next()});
+    mixer.compress<2>(clock);
+    mixer.compress<2>(address);
+    const uint64_t k0 = mixer.finish<2, 4>(0);
+    mixer.compress<2>(next());
+    return SipKey{k0, mixer.finish<2, 4>(1)};
+}
+
+} // namespace detail
+
+// SipHash-1-3, the reduced round variant used by hash tables in several language runtimes. Fast enough for every
+// lookup while keeping the output unpredictable for anyone who does not know the key.
+template <typename TBegin, std::sentinel_for<TBegin> TEnd>
+constexpr uint64_t sipHash13(const TBegin& begin, const TEnd& end, const SipKey& key) {
+    return detail::sipHash<1, 3>(begin, end, key);
+}
+
+constexpr uint64_t sipHash13(const std::string_view& stringView, const SipKey& key) {
+    return sipHash13(stringView.begin(), stringView.end(), key);
+}
+
+// SipHash-2-4, the original parameters with a wider security margin
+template <typename TBegin, std::sentinel_for<TBegin> TEnd>
+constexpr uint64_t sipHash24(const TBegin& begin, const TEnd& end, const SipKey& key) {
+    return detail::sipHash<2, 4>(begin, end, key);
+}
+
+constexpr uint64_t sipHash24(const std::string_view& stringView, const SipKey& key) {
+    return sipHash24(stringView.begin(), stringView.end(), key);
+}
+
+// Random key created on first use and shared by the whole process
+inline const SipKey& processKey() {
+    static const SipKey key = detail::randomSipKey();
+    return key;
+}
+
+// Hasher for hash containers that holds up against deliberately colliding keys, since an attacker can not predict
+// which keys collide without knowing the key. Transparent like DefaultHasher, so it drops into FlatHashMap.
+class KeyedHasher {
+  public:
+    using is_transparent = void;
+
+    KeyedHasher() : key(processKey()) {}
+    explicit KeyedHasher(const SipKey& key) : key(key) {}
+
+    size_t operator()(const std::string_view& stringView) const {
+        return static_cast<size_t>(sipHash13(stringView, key));
+    }
+
+    // Integers, enums and other types without padding hash their object representation
+    template <typename T>
+        requires(!std::convertible_to<const T&, std::string_view> && std::has_unique_object_representations_v<T>)
+    size_t operator()(const T& value) const {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+        return static_cast<size_t>(sipHash13(bytes, bytes + sizeof(T), key));
+    }
+
+  private:
+    SipKey key;
+};
+
+} // namespace hash
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "fnv1a.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <stdint.h>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace hash {
+namespace detail {
+namespace perfect {
+
+// Table slots, a power of two with at least 20% free so that displacements are found quickly
+constexpr size_t tableSize(size_t count) { return std::bit_ceil(count + count / 4 + 1); }
+
+// Roughly four keys per displacement bucket
+constexpr size_t bucketCount(size_t count) { return std::max<size_t>(1, tableSize(count) / 4); }
+
+// Top bits of a multiplicative mix, size must be a power of two
+constexpr size_t reduce(uint64_t value, size_t size) {
+    const int bits = std::countr_zero(size);
+    return bits == 0 ? 0 : static_cast<size_t>(value >> (64 - bits));
+}
+
+constexpr size_t bucketOf(uint64_t hash, size_t buckets) { return reduce(hash * 0xc2b2ae3d27d4eb4full, buckets); }
+
+constexpr size_t slotOf(uint64_t hash, uint32_t displacement, size_t slots) {
+    return reduce((hash ^ displacement) * 0x9e3779b97f4a7c15ull, slots);
+}
+
+} // namespace perfect
+} // namespace detail
+
+// Immutable string keyed map with a collision free layout computed at compile time. Each bucket of keys gets a
+// displacement that moves all of them to free slots, so a lookup is one FNV-1a hash, one probe and one compare.
+// Keys are views, they have to outlive the map, which string literals do.
+template <typename V, size_t N> class StaticMap {
+  private:
+    static_assert(N > 0, "StaticMap needs at least one entry");
+
+    using Index = std::conditional_t<(N < 0xffff), uint16_t, uint32_t>;
+
+    static constexpr size_t TableSize = detail::perfect::tableSize(N);
+    static constexpr size_t BucketCount = detail::perfect::bucketCount(N);
+    static constexpr Index Unused = static_cast<Index>(~Index(0));
+    static constexpr uint32_t MaxDisplacement = 1u << 20;
+
+  public:
+    using Entry = std::pair<std::string_view, V>;
+
+    consteval explicit StaticMap(const Entry (&source)[N]) : entries(std::to_array(source)) {
+        std::array<uint64_t, N> hashes{};
+        for (size_t i = 0; i < N; ++i) {
+            hashes[i] = fnv1a<uint64_t>(entries[i].first);
+        }
+
+        // Duplicate keys share a hash, and so would keys no displacement can separate
+        std::array<uint64_t, N> sorted = hashes;
+        std::sort(sorted.begin(), sorted.end());
+        if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+            throw std::invalid_argument("StaticMap keys must be unique");
+        }
+
+        // Group the keys by bucket
+        std::array<size_t, BucketCount + 1> bucketStart{};
+        for (size_t i = 0; i < N; ++i) {
+            ++bucketStart[detail::perfect::bucketOf(hashes[i], BucketCount) + 1];
+        }
+        for (size_t i = 0; i < BucketCount; ++i) {
+            bucketStart[i + 1] += bucketStart[i];
+        }
+
+        std::array<size_t, N> members{};
+        std::array<size_t, BucketCount> filled{};
+        for (size_t i = 0; i < N; ++i) {
+            const size_t bucket = detail::perfect::bucketOf(hashes[i], BucketCount);
+            members[bucketStart[bucket] + filled[bucket]++] = i;
+        }
+
+        // Placing the largest buckets first while the table is still empty keeps the search short
+        std::array<size_t, BucketCount> order{};
+        for (size_t i = 0; i < BucketCount; ++i) {
+            order[i] = i;
+        }
+        const auto bucketSize = [&](size_t bucket) { return bucketStart[bucket + 1] - bucketStart[bucket]; };
+        std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+            return bucketSize(lhs) != bucketSize(rhs) ? bucketSize(lhs) > bucketSize(rhs) : lhs < rhs;
+        });
+
+        slots.fill(Unused);
+        std::array<size_t, N> placed{};
+        for (const size_t bucket : order) {
+            if (bucketSize(bucket) == 0) {
+                break;
+            }
+            displacements[bucket] =
+                findDisplacement(members.data() + bucketStart[bucket], bucketSize(bucket), hashes, placed);
+        }
+    }
+
+    constexpr const V* find(std::string_view key) const {
+        const uint64_t hash = fnv1a<uint64_t>(key);
+        const uint32_t displacement = displacements[detail::perfect::bucketOf(hash, BucketCount)];
+        const Index index = slots[detail::perfect::slotOf(hash, displacement, TableSize)];
+        if (index == Unused || entries[index].first != key) {
+            return nullptr;
+        }
+        return &entries[index].second;
+    }
+
+    constexpr bool contains(std::string_view key) const { return find(key) != nullptr; }
+
+    constexpr const V& at(std::string_view key) const {
+        const V* value = find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("StaticMap: key not found");
+        }
+        return *value;
+    }
+
+    constexpr size_t size() const { return N; }
+
+    constexpr auto begin() const { return entries.begin(); }
+    constexpr auto end() const { return entries.end(); }
+
+  private:
+    consteval uint32_t findDisplacement(const size_t* members, size_t count, const std::array<uint64_t, N>& hashes,
+                                        std::array<size_t, N>& placed) {
+        for (uint32_t displacement = 0; displacement < MaxDisplacement; ++displacement) {
+            size_t fitted = 0;
+            for (; fitted < count; ++fitted) {
+                const size_t slot = detail::perfect::slotOf(hashes[members[fitted]], displacement, TableSize);
+                if (slots[slot] != Unused || std::find(placed.begin(), placed.begin() + fitted, slot) !=
+                                                 placed.begin() + fitted) {
+                    break;
+                }
+                placed[fitted] = slot;
+            }
+
+            if (fitted == count) {
+                for (size_t i = 0; i < count; ++i) {
+                    slots[placed[i]] = static_cast<Index>(members[i]);
+                }
+                return displacement;
+            }
+        }
+
+        throw std::invalid_argument("StaticMap could not place all keys");
+    }
+
+  private:
+    std::array<Entry, N> entries;
+    std::array<uint32_t, BucketCount> displacements{};
+    std::array<Index, TableSize> slots{};
+};
+
+template <typename V, size_t N>
+consteval StaticMap<V, N> makeStaticMap(const std::pair<std::string_view, V> (&entries)[N]) {
+    return StaticMap<V, N>(entries);
+}
+
+} // namespace hash
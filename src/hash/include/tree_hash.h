@@ -0,0 +1,85 @@
+#pragma once
+
+#include "hash_util.h"
+#include "xxhash.h"
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#if __has_include("mapped_file.h")
+#include "mapped_file.h"
+#endif
+
+namespace hash {
+namespace detail {
+namespace tree {
+
+// Seeds keep leaves, inner nodes and the root from ever producing the same digest for the same bytes
+constexpr uint64_t LeafSeed = 0x6c656166ull;
+constexpr uint64_t NodeSeed = 0x6e6f6465ull;
+constexpr uint64_t RootSeed = 0x726f6f74ull;
+
+// The digests are written as little endian bytes, so the tree hash is the same on every platform
+inline uint64_t combine(uint64_t left, uint64_t right, uint64_t seed) {
+    std::array<uint8_t, 16> bytes;
+    for (size_t i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<uint8_t>(left >> (8 * i));
+        bytes[i + 8] = static_cast<uint8_t>(right >> (8 * i));
+    }
+    return hash::xxh3(bytes.begin(), bytes.end(), seed);
+}
+
+} // namespace tree
+} // namespace detail
+
+// Leaf size of hashBuffer and hashFile, part of the definition of the digest
+constexpr size_t TreeHashChunkSize = size_t(1) << 20;
+
+// Hashes the buffer as a binary tree: XXH3 of every 1 MiB chunk, then pairs of digests combined level by level, with
+// an odd digest at the end of a level moving up unchanged, and finally the root mixed with the total length. The
+// chunks are hashed on up to `threads` threads, zero uses every hardware thread, and the digest is the same for every
+// thread count.
+inline uint64_t hashBuffer(std::span<const uint8_t> data, unsigned threads = 0) {
+    using namespace detail::tree;
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const size_t leafCount = std::max<size_t>(1, (data.size() + TreeHashChunkSize - 1) / TreeHashChunkSize);
+    std::vector<uint64_t> level(leafCount);
+    detail::parallelFor(leafCount, threads, 1, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            const size_t offset = i * TreeHashChunkSize;
+            const auto chunk = data.subspan(offset, std::min(TreeHashChunkSize, data.size() - offset));
+            level[i] = xxh3(chunk.begin(), chunk.end(), LeafSeed);
+        }
+    });
+
+    while (level.size() > 1) {
+        const size_t pairs = level.size() / 2;
+        for (size_t i = 0; i < pairs; ++i) {
+            level[i] = combine(level[2 * i], level[2 * i + 1], NodeSeed);
+        }
+        if (level.size() % 2 != 0) {
+            level[pairs] = level.back();
+        }
+        level.resize(level.size() - pairs);
+    }
+
+    return combine(level[0], data.size(), RootSeed);
+}
+
+#if __has_include("mapped_file.h")
+// hashBuffer of the file contents, hashed straight from a memory mapping
+inline uint64_t hashFile(const std::filesystem::path& path, unsigned threads = 0) {
+    const memory::MappedFile file(path);
+    return hashBuffer(file.bytes(), threads);
+}
+#endif
+
+} // namespace hash
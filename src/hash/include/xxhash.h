@@ -0,0 +1,452 @@
+#pragma once
+
+#include "dispatch.h"
+#include "hash_util.h"
+
+#include <iterator>
+#include <stdint.h>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#if __has_include("int128.h")
+#include "int128.h"
+#endif
+
+#if defined(CPPUTILS_HASH_DISPATCH)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace hash {
+namespace detail {
+
+struct Xxh3Constants {
+    static constexpr uint64_t Prime32_1 = 0x9e3779b1ull;
+    static constexpr uint64_t Prime32_2 = 0x85ebca77ull;
+    static constexpr uint64_t Prime32_3 = 0xc2b2ae3dull;
+    static constexpr uint64_t Prime64_1 = 0x9e3779b185ebca87ull;
+    static constexpr uint64_t Prime64_2 = 0xc2b2ae3d27d4eb4full;
+    static constexpr uint64_t Prime64_3 = 0x165667b19e3779f9ull;
+    static constexpr uint64_t Prime64_4 = 0x85ebca77c2b2ae63ull;
+    static constexpr uint64_t Prime64_5 = 0x27d4eb2f165667c5ull;
+    static constexpr uint64_t PrimeMx1 = 0x165667919e3779f9ull;
+    static constexpr uint64_t PrimeMx2 = 0x9fb21c651e98df25ull;
+
+    static constexpr size_t StripeLength = 64;
+    static constexpr size_t SecretConsumeRate = 8;
+    static constexpr size_t Accumulators = 8;
+    static constexpr size_t SecretSize = 192;
+    static constexpr size_t SecretSizeMin = 136;
+    static constexpr size_t MidSizeMax = 240;
+    static constexpr size_t MidSizeStartOffset = 3;
+    static constexpr size_t MidSizeLastOffset = 17;
+    static constexpr size_t LastAccumulatorStart = 7;
+    static constexpr size_t MergeAccumulatorsStart = 11;
+};
+
+alignas(64) inline constexpr uint8_t Xxh3Secret[Xxh3Constants::SecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d,
+    0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0,
+    0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21, 0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0,
+    0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b,
+    0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac,
+    0xd8, 0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51,
+    0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83, 0x34,
+    0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb, 0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49,
+    0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8,
+    0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b,
+    0x40, 0x7e,
+};
+
+// Little endian load that also works in constant evaluation
+template <typename T, typename TByte> constexpr T readLittleEndian(const TByte* data) {
+    if (!std::is_constant_evaluated()) {
+        return load<T>(data);
+    }
+
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(static_cast<uint8_t>(data[i])) << (i * 8);
+    }
+    return value;
+}
+
+constexpr uint64_t xorShift(uint64_t value, int shift) { return value ^ (value >> shift); }
+
+constexpr uint64_t rotl64(uint64_t value, int count) { return (value << count) | (value >> (64 - count)); }
+
+// Multiplies into 128 bits and folds the halves together
+constexpr uint64_t mulFold64(uint64_t lhs, uint64_t rhs) {
+#ifdef CPPUTILS_UINT128
+    const uint128_t product = static_cast<uint128_t>(lhs) * rhs;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    const uint64_t loLo = (lhs & 0xffffffff) * (rhs & 0xffffffff);
+    const uint64_t hiLo = (lhs >> 32) * (rhs & 0xffffffff);
+    const uint64_t loHi = (lhs & 0xffffffff) * (rhs >> 32);
+    const uint64_t hiHi = (lhs >> 32) * (rhs >> 32);
+    const uint64_t cross = (loLo >> 32) + (hiLo & 0xffffffff) + loHi;
+    const uint64_t upper = (hiLo >> 32) + (cross >> 32) + hiHi;
+    const uint64_t lower = (cross << 32) | (loLo & 0xffffffff);
+    return lower ^ upper;
+#endif
+}
+
+constexpr uint64_t xxh64Avalanche(uint64_t hash) {
+    hash = xorShift(hash, 33) * Xxh3Constants::Prime64_2;
+    hash = xorShift(hash, 29) * Xxh3Constants::Prime64_3;
+    return xorShift(hash, 32);
+}
+
+constexpr uint64_t xxh3Avalanche(uint64_t hash) {
+    hash = xorShift(hash, 37) * Xxh3Constants::PrimeMx1;
+    return xorShift(hash, 32);
+}
+
+constexpr uint64_t xxh3Rrmxmx(uint64_t hash, uint64_t length) {
+    hash ^= rotl64(hash, 49) ^ rotl64(hash, 24);
+    hash *= Xxh3Constants::PrimeMx2;
+    hash ^= (hash >> 35) + length;
+    hash *= Xxh3Constants::PrimeMx2;
+    return xorShift(hash, 28);
+}
+
+template <typename TByte>
+constexpr uint64_t xxh3Mix16(const TByte* input, const uint8_t* secret, uint64_t seed) {
+    const uint64_t low = readLittleEndian<uint64_t>(input);
+    const uint64_t high = readLittleEndian<uint64_t>(input + 8);
+    return mulFold64(low ^ (readLittleEndian<uint64_t>(secret) + seed),
+                     high ^ (readLittleEndian<uint64_t>(secret + 8) - seed));
+}
+
+template <typename TByte>
+constexpr uint64_t xxh3Short(const TByte* input, size_t length, const uint8_t* secret, uint64_t seed) {
+    if (length > 8) {
+        const uint64_t flip1 =
+            (readLittleEndian<uint64_t>(secret + 24) ^ readLittleEndian<uint64_t>(secret + 32)) + seed;
+        const uint64_t flip2 =
+            (readLittleEndian<uint64_t>(secret + 40) ^ readLittleEndian<uint64_t>(secret + 48)) - seed;
+        const uint64_t low = readLittleEndian<uint64_t>(input) ^ flip1;
+        const uint64_t high = readLittleEndian<uint64_t>(input + length - 8) ^ flip2;
+        return xxh3Avalanche(length + byteSwap(low) + high + mulFold64(low, high));
+    }
+
+    if (length >= 4) {
+        seed ^= static_cast<uint64_t>(byteSwap(static_cast<uint32_t>(seed))) << 32;
+        const uint64_t input1 = readLittleEndian<uint32_t>(input);
+        const uint64_t input2 = readLittleEndian<uint32_t>(input + length - 4);
+        const uint64_t flip = (readLittleEndian<uint64_t>(secret + 8) ^ readLittleEndian<uint64_t>(secret + 16)) - seed;
+        return xxh3Rrmxmx((input2 + (input1 << 32)) ^ flip, length);
+    }
+
+    if (length > 0) {
+        const uint32_t c1 = static_cast<uint8_t>(input[0]);
+        const uint32_t c2 = static_cast<uint8_t>(input[length >> 1]);
+        const uint32_t c3 = static_cast<uint8_t>(input[length - 1]);
+        const uint32_t combined = (c1 << 16) | (c2 << 24) | c3 | (static_cast<uint32_t>(length) << 8);
+        const uint64_t flip = (readLittleEndian<uint32_t>(secret) ^ readLittleEndian<uint32_t>(secret + 4)) + seed;
+        return xxh64Avalanche(combined ^ flip);
+    }
+
+    return xxh64Avalanche(seed ^ readLittleEndian<uint64_t>(secret + 56) ^ readLittleEndian<uint64_t>(secret + 64));
+}
+
+template <typename TByte>
+constexpr uint64_t xxh3Medium(const TByte* input, size_t length, const uint8_t* secret, uint64_t seed) {
+    using Constants = Xxh3Constants;
+
+    uint64_t acc = length * Constants::Prime64_1;
+
+    if (length <= 128) {
+        const size_t rounds = (length - 1) / 32;
+        for (size_t i = 0; i <= rounds; ++i) {
+            acc += xxh3Mix16(input + 16 * i, secret + 32 * i, seed);
+            acc += xxh3Mix16(input + length - 16 * (i + 1), secret + 32 * i + 16, seed);
+        }
+        return xxh3Avalanche(acc);
+    }
+
+    for (size_t i = 0; i < 8; ++i) {
+        acc += xxh3Mix16(input + 16 * i, secret + 16 * i, seed);
+    }
+    acc = xxh3Avalanche(acc);
+
+    uint64_t accEnd =
+        xxh3Mix16(input + length - 16, secret + Constants::SecretSizeMin - Constants::MidSizeLastOffset, seed);
+    for (size_t i = 8; i < length / 16; ++i) {
+        accEnd += xxh3Mix16(input + 16 * i, secret + 16 * (i - 8) + Constants::MidSizeStartOffset, seed);
+    }
+    return xxh3Avalanche(acc + accEnd);
+}
+
+// Striped accumulation over 64 byte stripes, eight 64 bit lanes per stripe
+template <typename TByte>
+constexpr void xxh3AccumulateScalar(uint64_t* acc, const TByte* input, const uint8_t* secret, size_t stripes) {
+    for (size_t n = 0; n < stripes; ++n) {
+        const TByte* stripe = input + n * Xxh3Constants::StripeLength;
+        const uint8_t* key = secret + n * Xxh3Constants::SecretConsumeRate;
+        for (size_t i = 0; i < Xxh3Constants::Accumulators; ++i) {
+            const uint64_t data = readLittleEndian<uint64_t>(stripe + i * 8);
+            const uint64_t keyed = data ^ readLittleEndian<uint64_t>(key + i * 8);
+            acc[i ^ 1] += data;
+            acc[i] += (keyed & 0xffffffff) * (keyed >> 32);
+        }
+    }
+}
+
+constexpr void xxh3ScrambleScalar(uint64_t* acc, const uint8_t* secret) {
+    for (size_t i = 0; i < Xxh3Constants::Accumulators; ++i) {
+        uint64_t value = xorShift(acc[i], 47) ^ readLittleEndian<uint64_t>(secret + i * 8);
+        acc[i] = value * Xxh3Constants::Prime32_1;
+    }
+}
+
+using Xxh3AccumulateFunction = void (*)(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripes);
+using Xxh3ScrambleFunction = void (*)(uint64_t* acc, const uint8_t* secret);
+
+struct Xxh3Kernels {
+    Xxh3AccumulateFunction accumulate;
+    Xxh3ScrambleFunction scramble;
+};
+
+// SSE2 is part of x86-64 and the baseline, the wider kernels are compiled into every x86 build and picked at runtime
+#if defined(__SSE2__) || defined(_M_X64)
+namespace sse2 {
+inline void xxh3Accumulate(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    __m128i* lanes = reinterpret_cast<__m128i*>(acc);
+    __m128i accs[4];
+    for (size_t i = 0; i < 4; ++i) {
+        accs[i] = _mm_loadu_si128(lanes + i);
+    }
+
+    for (size_t n = 0; n < stripes; ++n) {
+        const __m128i* stripe = reinterpret_cast<const __m128i*>(input + n * Xxh3Constants::StripeLength);
+        const __m128i* key = reinterpret_cast<const __m128i*>(secret + n * Xxh3Constants::SecretConsumeRate);
+
+        for (size_t i = 0; i < 4; ++i) {
+            const __m128i data = _mm_loadu_si128(stripe + i);
+            const __m128i keyed = _mm_xor_si128(data, _mm_loadu_si128(key + i));
+            const __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            accs[i] = _mm_add_epi64(accs[i], _mm_add_epi64(product, _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+    }
+
+    for (size_t i = 0; i < 4; ++i) {
+        _mm_storeu_si128(lanes + i, accs[i]);
+    }
+}
+
+inline void xxh3Scramble(uint64_t* acc, const uint8_t* secret) {
+    __m128i* lanes = reinterpret_cast<__m128i*>(acc);
+    const __m128i* key = reinterpret_cast<const __m128i*>(secret);
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(Xxh3Constants::Prime32_1));
+
+    for (size_t i = 0; i < 4; ++i) {
+        const __m128i value = _mm_loadu_si128(lanes + i);
+        const __m128i keyed = _mm_xor_si128(_mm_xor_si128(value, _mm_srli_epi64(value, 47)), _mm_loadu_si128(key + i));
+        const __m128i productLow = _mm_mul_epu32(keyed, prime);
+        const __m128i productHigh = _mm_mul_epu32(_mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+        _mm_storeu_si128(lanes + i, _mm_add_epi64(productLow, _mm_slli_epi64(productHigh, 32)));
+    }
+}
+} // namespace sse2
+#endif
+
+#ifdef CPPUTILS_HASH_DISPATCH
+namespace avx2 {
+CPPUTILS_HASH_TARGET_REGION("avx2")
+
+inline void xxh3Accumulate(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    __m256i* lanes = reinterpret_cast<__m256i*>(acc);
+    __m256i acc0 = _mm256_loadu_si256(lanes);
+    __m256i acc1 = _mm256_loadu_si256(lanes + 1);
+
+    for (size_t n = 0; n < stripes; ++n) {
+        const __m256i* stripe = reinterpret_cast<const __m256i*>(input + n * Xxh3Constants::StripeLength);
+        const __m256i* key = reinterpret_cast<const __m256i*>(secret + n * Xxh3Constants::SecretConsumeRate);
+
+        const __m256i data0 = _mm256_loadu_si256(stripe);
+        const __m256i data1 = _mm256_loadu_si256(stripe + 1);
+        const __m256i keyed0 = _mm256_xor_si256(data0, _mm256_loadu_si256(key));
+        const __m256i keyed1 = _mm256_xor_si256(data1, _mm256_loadu_si256(key + 1));
+        const __m256i product0 = _mm256_mul_epu32(keyed0, _mm256_srli_epi64(keyed0, 32));
+        const __m256i product1 = _mm256_mul_epu32(keyed1, _mm256_srli_epi64(keyed1, 32));
+        acc0 = _mm256_add_epi64(acc0, _mm256_add_epi64(product0, _mm256_shuffle_epi32(data0, _MM_SHUFFLE(1, 0, 3, 2))));
+        acc1 = _mm256_add_epi64(acc1, _mm256_add_epi64(product1, _mm256_shuffle_epi32(data1, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+
+    _mm256_storeu_si256(lanes, acc0);
+    _mm256_storeu_si256(lanes + 1, acc1);
+}
+
+inline void xxh3Scramble(uint64_t* acc, const uint8_t* secret) {
+    __m256i* lanes = reinterpret_cast<__m256i*>(acc);
+    const __m256i* key = reinterpret_cast<const __m256i*>(secret);
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(Xxh3Constants::Prime32_1));
+
+    for (size_t i = 0; i < 2; ++i) {
+        const __m256i value = _mm256_loadu_si256(lanes + i);
+        const __m256i keyed =
+            _mm256_xor_si256(_mm256_xor_si256(value, _mm256_srli_epi64(value, 47)), _mm256_loadu_si256(key + i));
+        const __m256i productLow = _mm256_mul_epu32(keyed, prime);
+        const __m256i productHigh = _mm256_mul_epu32(_mm256_srli_epi64(keyed, 32), prime);
+        _mm256_storeu_si256(lanes + i, _mm256_add_epi64(productLow, _mm256_slli_epi64(productHigh, 32)));
+    }
+}
+
+CPPUTILS_HASH_TARGET_REGION_END
+} // namespace avx2
+
+namespace avx512 {
+CPPUTILS_HASH_TARGET_REGION("avx512f")
+
+// A whole stripe per vector. The zero masked forms of the intrinsics are used because GCC 12 warns about the undefined
+// pass through value of the plain ones.
+inline void xxh3Accumulate(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    __m512i lanes = _mm512_loadu_si512(acc);
+
+    for (size_t n = 0; n < stripes; ++n) {
+        const __m512i data = _mm512_loadu_si512(input + n * Xxh3Constants::StripeLength);
+        const __m512i keyed = _mm512_xor_si512(data, _mm512_loadu_si512(secret + n * Xxh3Constants::SecretConsumeRate));
+        const __m512i product = _mm512_maskz_mul_epu32(0xff, keyed, _mm512_maskz_srli_epi64(0xff, keyed, 32));
+        const __m512i swapped =
+            _mm512_maskz_shuffle_epi32(0xffff, data, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(1, 0, 3, 2)));
+        lanes = _mm512_add_epi64(lanes, _mm512_add_epi64(product, swapped));
+    }
+
+    _mm512_storeu_si512(acc, lanes);
+}
+
+inline void xxh3Scramble(uint64_t* acc, const uint8_t* secret) {
+    const __m512i prime = _mm512_set1_epi32(static_cast<int>(Xxh3Constants::Prime32_1));
+    const __m512i value = _mm512_loadu_si512(acc);
+    const __m512i keyed =
+        _mm512_xor_si512(_mm512_xor_si512(value, _mm512_maskz_srli_epi64(0xff, value, 47)), _mm512_loadu_si512(secret));
+    const __m512i productLow = _mm512_maskz_mul_epu32(0xff, keyed, prime);
+    const __m512i productHigh = _mm512_maskz_mul_epu32(0xff, _mm512_maskz_srli_epi64(0xff, keyed, 32), prime);
+    _mm512_storeu_si512(acc, _mm512_add_epi64(productLow, _mm512_maskz_slli_epi64(0xff, productHigh, 32)));
+}
+
+CPPUTILS_HASH_TARGET_REGION_END
+} // namespace avx512
+#endif
+
+inline Xxh3Kernels selectXxh3Kernels(IsaLevel level = isaLevel()) {
+    static constexpr Kernel<Xxh3Kernels> Kernels[] = {
+#ifdef CPPUTILS_HASH_DISPATCH
+        {IsaLevel::Avx512, {&avx512::xxh3Accumulate, &avx512::xxh3Scramble}},
+        {IsaLevel::Avx2, {&avx2::xxh3Accumulate, &avx2::xxh3Scramble}},
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+        {IsaLevel::Scalar, {&sse2::xxh3Accumulate, &sse2::xxh3Scramble}},
+#else
+        {IsaLevel::Scalar, {&xxh3AccumulateScalar<uint8_t>, &xxh3ScrambleScalar}},
+#endif
+    };
+    return selectKernel(Kernels, level);
+}
+
+inline const Xxh3Kernels& xxh3Kernels() {
+    static const Xxh3Kernels kernels = selectXxh3Kernels();
+    return kernels;
+}
+
+template <typename TByte>
+constexpr void xxh3Accumulate(uint64_t* acc, const TByte* input, const uint8_t* secret, size_t stripes) {
+    if (std::is_constant_evaluated()) {
+        xxh3AccumulateScalar(acc, input, secret, stripes);
+    } else {
+        xxh3Kernels().accumulate(acc, reinterpret_cast<const uint8_t*>(input), secret, stripes);
+    }
+}
+
+constexpr void xxh3Scramble(uint64_t* acc, const uint8_t* secret) {
+    if (std::is_constant_evaluated()) {
+        xxh3ScrambleScalar(acc, secret);
+    } else {
+        xxh3Kernels().scramble(acc, secret);
+    }
+}
+
+template <typename TByte>
+constexpr uint64_t xxh3Long(const TByte* input, size_t length, const uint8_t* secret) {
+    using Constants = Xxh3Constants;
+
+    constexpr size_t StripesPerBlock = (Constants::SecretSize - Constants::StripeLength) / Constants::SecretConsumeRate;
+    constexpr size_t BlockLength = Constants::StripeLength * StripesPerBlock;
+
+    alignas(32) uint64_t acc[Constants::Accumulators] = {
+        Constants::Prime32_3, Constants::Prime64_1, Constants::Prime64_2, Constants::Prime64_3,
+        Constants::Prime64_4, Constants::Prime32_2, Constants::Prime64_5, Constants::Prime32_1,
+    };
+
+    const size_t blocks = (length - 1) / BlockLength;
+    for (size_t n = 0; n < blocks; ++n) {
+        xxh3Accumulate(acc, input + n * BlockLength, secret, StripesPerBlock);
+        xxh3Scramble(acc, secret + Constants::SecretSize - Constants::StripeLength);
+    }
+
+    const size_t stripes = ((length - 1) - BlockLength * blocks) / Constants::StripeLength;
+    xxh3Accumulate(acc, input + blocks * BlockLength, secret, stripes);
+    xxh3Accumulate(acc, input + length - Constants::StripeLength,
+                   secret + Constants::SecretSize - Constants::StripeLength - Constants::LastAccumulatorStart, 1);
+
+    uint64_t result = length * Constants::Prime64_1;
+    const uint8_t* mergeSecret = secret + Constants::MergeAccumulatorsStart;
+    for (size_t i = 0; i < 4; ++i) {
+        result += mulFold64(acc[2 * i] ^ readLittleEndian<uint64_t>(mergeSecret + 16 * i),
+                            acc[2 * i + 1] ^ readLittleEndian<uint64_t>(mergeSecret + 16 * i + 8));
+    }
+    return xxh3Avalanche(result);
+}
+
+template <typename TByte> constexpr uint64_t xxh3(const TByte* input, size_t length, uint64_t seed) {
+    if (length <= 16) {
+        return xxh3Short(input, length, Xxh3Secret, seed);
+    }
+    if (length <= Xxh3Constants::MidSizeMax) {
+        return xxh3Medium(input, length, Xxh3Secret, seed);
+    }
+    if (seed == 0) {
+        return xxh3Long(input, length, Xxh3Secret);
+    }
+
+    // Long inputs derive a secret from the seed instead of mixing it in per stripe
+    alignas(32) uint8_t secret[Xxh3Constants::SecretSize] = {};
+    for (size_t i = 0; i < Xxh3Constants::SecretSize; i += 16) {
+        const uint64_t low = readLittleEndian<uint64_t>(Xxh3Secret + i) + seed;
+        const uint64_t high = readLittleEndian<uint64_t>(Xxh3Secret + i + 8) - seed;
+        for (size_t j = 0; j < 8; ++j) {
+            secret[i + j] = static_cast<uint8_t>(low >> (j * 8));
+            secret[i + 8 + j] = static_cast<uint8_t>(high >> (j * 8));
+        }
+    }
+    return xxh3Long(input, length, secret);
+}
+
+} // namespace detail
+
+// XXH3 64 bit hash. Unlike the other hashes the whole input is needed up front, so non-contiguous input is first
+// copied into a buffer.
+template <typename TBegin, std::sentinel_for<TBegin> TEnd>
+constexpr uint64_t xxh3(const TBegin& begin, const TEnd& end, uint64_t seed = 0) {
+    static_assert(sizeof(*begin) == 1, "Iterators must produce single byte values");
+
+    if constexpr (detail::ContiguousBytes<TBegin, TEnd>) {
+        return detail::xxh3(std::to_address(begin), static_cast<size_t>(end - begin), seed);
+    } else {
+        std::vector<uint8_t> buffer;
+        for (auto iterator = begin; iterator != end; ++iterator) {
+            buffer.push_back(static_cast<uint8_t>(*iterator));
+        }
+        return detail::xxh3(buffer.data(), buffer.size(), seed);
+    }
+}
+
+constexpr uint64_t xxh3(const std::string_view& stringView, uint64_t seed = 0) {
+    return xxh3(stringView.begin(), stringView.end(), seed);
+}
+
+} // namespace hash
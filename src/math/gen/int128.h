@@ -31,8 +31,9 @@ using int128_t = _ExtInt(128);
 #include <__msvc_int128.hpp>
 using int128_t = std::_Signed128;
 #else
-#undef CPPUTILS_INT128
 #undef CPPUTILS_INT128_BUILTIN
+#include "int128_portable.h"
+using int128_t = math::Int128;
 #endif
 
 #define CPPUTILS_UINT128 1
@@ -52,8 +53,9 @@ using uint128_t = unsigned _ExtInt(128);
 #include <__msvc_int128.hpp>
 using uint128_t = std::_Unsigned128;
 #else
-#undef CPPUTILS_UINT128
 #undef CPPUTILS_UINT128_BUILTIN
+#include "int128_portable.h"
+using uint128_t = math::UInt128;
 #endif
 
 #undef HAVE_CPPUTILS_INT128_STDINT
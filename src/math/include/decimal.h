@@ -0,0 +1,459 @@
+#pragma once
+
+#include "divider.h"
+#include "int128.h"
+#include "int128_charconv.h"
+#include "int128_portable.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <stdexcept>
+#include <stdint.h>
+#include <string_view>
+#include <system_error>
+
+namespace math {
+namespace detail {
+namespace decimal {
+
+// 256 bit intermediate of products and scaled dividends, least significant limb first
+using Wide = std::array<uint64_t, 4>;
+
+constexpr int MaxScale = 38;
+
+constexpr std::array<uint128_t, MaxScale + 1> PowersOf10 = [] {
+    std::array<uint128_t, MaxScale + 1> powers{};
+    uint128_t power = 1;
+    for (uint128_t& entry : powers) {
+        entry = power;
+        power *= 10;
+    }
+    return powers;
+}();
+
+// Rescaling divides by the same powers over and over, which the dividers turn into multiplications
+template <int Exponent> constexpr Divider<uint128_t> PowerDivider(PowersOf10[Exponent]);
+
+constexpr uint64_t lowLimb(const uint128_t& value) {
+    return static_cast<uint64_t>(value);
+}
+
+constexpr uint64_t highLimb(const uint128_t& value) {
+    return static_cast<uint64_t>(value >> 64);
+}
+
+constexpr uint128_t join(uint64_t high, uint64_t low) {
+    return (uint128_t(high) << 64) | uint128_t(low);
+}
+
+constexpr Wide multiply(const uint128_t& lhs, const uint128_t& rhs) {
+    const uint64_t lhsLimbs[2] = {lowLimb(lhs), highLimb(lhs)};
+    const uint64_t rhsLimbs[2] = {lowLimb(rhs), highLimb(rhs)};
+    Wide result{};
+    for (int i = 0; i < 2; ++i) {
+        uint64_t carry = 0;
+        for (int j = 0; j < 2; ++j) {
+            // lhs * rhs + two limbs still fits in 128 bits, so the high half takes both carries
+            uint64_t low = 0;
+            uint64_t high = int128::multiplyWide(lhsLimbs[i], rhsLimbs[j], low);
+            high += int128::addOverflow(low, carry, low);
+            high += int128::addOverflow(result[i + j], low, result[i + j]);
+            carry = high;
+        }
+        result[i + 2] = carry;
+    }
+    return result;
+}
+
+// Knuth's algorithm D on 32 bit digits, after divmnu in Hacker's Delight. The divisor has no leading zero digits and
+// at least two of them, the dividend has at least as many digits and room for one more.
+constexpr void divideDigits(uint32_t* quotient, uint32_t* remainder, const uint32_t* dividend, const uint32_t* divisor,
+                            int dividendDigits, int divisorDigits) {
+    constexpr uint64_t Base = uint64_t(1) << 32;
+    const int shift = std::countl_zero(divisor[divisorDigits - 1]);
+
+    uint32_t normalizedDivisor[4] = {};
+    for (int i = divisorDigits - 1; i > 0; --i) {
+        normalizedDivisor[i] = (divisor[i] << shift) | static_cast<uint32_t>(uint64_t(divisor[i - 1]) >> (32 - shift));
+    }
+    normalizedDivisor[0] = divisor[0] << shift;
+
+    uint32_t normalized[9] = {};
+    normalized[dividendDigits] = static_cast<uint32_t>(uint64_t(dividend[dividendDigits - 1]) >> (32 - shift));
+    for (int i = dividendDigits - 1; i > 0; --i) {
+        normalized[i] = (dividend[i] << shift) | static_cast<uint32_t>(uint64_t(dividend[i - 1]) >> (32 - shift));
+    }
+    normalized[0] = dividend[0] << shift;
+
+    const uint64_t top = normalizedDivisor[divisorDigits - 1];
+    const uint64_t next = normalizedDivisor[divisorDigits - 2];
+    for (int j = dividendDigits - divisorDigits; j >= 0; --j) {
+        const uint64_t head = normalized[j + divisorDigits] * Base + normalized[j + divisorDigits - 1];
+        uint64_t estimate = head / top;
+        uint64_t rest = head - estimate * top;
+        while (estimate >= Base || estimate * next > Base * rest + normalized[j + divisorDigits - 2]) {
+            --estimate;
+            rest += top;
+            if (rest >= Base) {
+                break;
+            }
+        }
+
+        int64_t borrow = 0;
+        int64_t difference = 0;
+        for (int i = 0; i < divisorDigits; ++i) {
+            const uint64_t product = estimate * normalizedDivisor[i];
+            difference = static_cast<int64_t>(normalized[i + j] - borrow - (product & 0xffffffff));
+            normalized[i + j] = static_cast<uint32_t>(difference);
+            borrow = static_cast<int64_t>(product >> 32) - (difference >> 32);
+        }
+        difference = static_cast<int64_t>(normalized[j + divisorDigits] - borrow);
+        normalized[j + divisorDigits] = static_cast<uint32_t>(difference);
+
+        quotient[j] = static_cast<uint32_t>(estimate);
+        // The estimate was one too large, add the divisor back
+        if (difference < 0) {
+            --quotient[j];
+            uint64_t carry = 0;
+            for (int i = 0; i < divisorDigits; ++i) {
+                const uint64_t sum = uint64_t(normalized[i + j]) + normalizedDivisor[i] + carry;
+                normalized[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            normalized[j + divisorDigits] += static_cast<uint32_t>(carry);
+        }
+    }
+
+    for (int i = 0; i < divisorDigits - 1; ++i) {
+        remainder[i] = (normalized[i] >> shift) | static_cast<uint32_t>(uint64_t(normalized[i + 1]) << (32 - shift));
+    }
+    remainder[divisorDigits - 1] = normalized[divisorDigits - 1] >> shift;
+}
+
+// Long division by a single limb
+constexpr bool divideLimb(const Wide& dividend, uint64_t divisor, uint128_t& quotient, uint128_t& remainder) {
+    int top = 3;
+    while (top > 0 && dividend[top] == 0) {
+        --top;
+    }
+    if (top > 2 || (top == 2 && dividend[2] >= divisor)) {
+        return false;
+    }
+
+    // A third limb below the divisor starts out as the remainder
+    uint64_t rest = top == 2 ? dividend[2] : 0;
+    uint64_t limbs[2] = {};
+    for (int i = std::min(top, 1); i >= 0; --i) {
+        limbs[i] = int128::divideWide(rest, dividend[i], divisor, rest);
+    }
+    quotient = join(limbs[1], limbs[0]);
+    remainder = rest;
+    return true;
+}
+
+// Quotient rounded half to even, false when it does not fit in 128 bits. The divider is optional and has to be the
+// one of the divisor.
+constexpr bool divideRounded(const Wide& dividend, const uint128_t& divisor, uint128_t& result,
+                             const Divider<uint128_t>* divider = nullptr) {
+    uint128_t quotient = 0;
+    uint128_t remainder = 0;
+    if (dividend[2] == 0 && dividend[3] == 0) {
+        const uint128_t narrow = join(dividend[1], dividend[0]);
+        if (divider != nullptr) {
+            quotient = divider->divide(narrow);
+            remainder = narrow - quotient * divisor;
+        } else {
+            const DivMod<uint128_t> division = divmod(narrow, divisor);
+            quotient = division.quotient;
+            remainder = division.remainder;
+        }
+    } else if (highLimb(divisor) == 0) {
+        if (!divideLimb(dividend, lowLimb(divisor), quotient, remainder)) {
+            return false;
+        }
+    } else {
+        uint32_t dividendDigits[8] = {};
+        uint32_t divisorDigits[4] = {};
+        for (int i = 0; i < 4; ++i) {
+            dividendDigits[2 * i] = static_cast<uint32_t>(dividend[i]);
+            dividendDigits[2 * i + 1] = static_cast<uint32_t>(dividend[i] >> 32);
+        }
+        for (int i = 0; i < 4; ++i) {
+            divisorDigits[i] = static_cast<uint32_t>(divisor >> (32 * i));
+        }
+
+        int dividendLength = 8;
+        while (dividendDigits[dividendLength - 1] == 0) {
+            --dividendLength;
+        }
+        int divisorLength = 4;
+        while (divisorDigits[divisorLength - 1] == 0) {
+            --divisorLength;
+        }
+        // The divisor has at least three digits here, so this is certainly more than 128 bits
+        if (dividendLength - divisorLength > 4) {
+            return false;
+        }
+
+        uint32_t quotientDigits[8] = {};
+        uint32_t remainderDigits[4] = {};
+        divideDigits(quotientDigits, remainderDigits, dividendDigits, divisorDigits, dividendLength, divisorLength);
+        if (quotientDigits[4] != 0) {
+            return false;
+        }
+        for (int i = 3; i >= 0; --i) {
+            quotient = (quotient << 32) | uint128_t(quotientDigits[i]);
+            remainder = (remainder << 32) | uint128_t(remainderDigits[i]);
+        }
+    }
+
+    // Compares the remainder with half of the divisor without doubling it. Which way a value rounds is as good as
+    // random, so the increment is added instead of branched on.
+    const uint128_t complement = divisor - remainder;
+    const bool up = (remainder > complement) | ((remainder == complement) & ((lowLimb(quotient) & 1) != 0));
+    result = quotient + uint128_t(up);
+    return !(up && result == 0);
+}
+
+// value * factor + addend, false on overflow
+constexpr bool multiplyAdd(uint128_t& value, uint64_t factor, uint64_t addend) {
+    uint64_t lowLow = 0;
+    uint64_t highLow = 0;
+    const uint64_t lowHigh = int128::multiplyWide(lowLimb(value), factor, lowLow);
+    const uint64_t highHigh = int128::multiplyWide(highLimb(value), factor, highLow);
+
+    uint64_t high = 0;
+    const bool carry = int128::addOverflow(lowLow, addend, lowLow);
+    const bool overflow = int128::addOverflow(lowHigh, highLow, high) | int128::addOverflow(high, carry, high);
+    if (highHigh != 0 || overflow) {
+        return false;
+    }
+    value = join(high, lowLow);
+    return true;
+}
+
+// Appends decimal digits to value, false on overflow
+constexpr bool appendDigits(uint128_t& value, const char* first, const char* last) {
+    while (first != last && *first == '0' && value == 0) {
+        ++first;
+    }
+    while (first != last) {
+        const int count = static_cast<int>(std::min<ptrdiff_t>(last - first, charconv::ChunkDigits));
+        if (!multiplyAdd(value, charconv::PowersOf10[count], charconv::parseChunk(first, count))) {
+            return false;
+        }
+        first += count;
+    }
+    return true;
+}
+
+} // namespace decimal
+} // namespace detail
+
+// Fixed point decimal with Scale fractional digits, stored as an int128_t count of 10^-Scale units. That covers 38
+// significant digits, and exactly represents every value with at most Scale fractional digits, which binary floating
+// point does not.
+// Addition and subtraction are exact. Products, quotients and rescaling to fewer digits are rounded half to even.
+// Results that do not fit throw std::overflow_error, division by zero throws std::domain_error.
+template <int Scale> class Decimal {
+    static_assert(Scale >= 0 && Scale <= detail::decimal::MaxScale, "Scale has to be in [0, 38]");
+
+  public:
+    static constexpr int scale = Scale;
+    // Sign, 39 digits and the decimal point, or a leading zero for values below one
+    static constexpr size_t maxChars = 1 + std::max(39 - Scale, 1) + (Scale == 0 ? 0 : Scale + 1);
+
+    constexpr Decimal() = default;
+
+    template <std::integral T> constexpr Decimal(T value) : Decimal(rescale(Decimal<0>::fromRaw(int128_t(value)))) {}
+
+    template <int OtherScale>
+    explicit constexpr Decimal(const Decimal<OtherScale>& other) : Decimal(rescale(other)) {}
+
+    static constexpr Decimal fromRaw(const int128_t& raw) {
+        Decimal result;
+        result.units = raw;
+        return result;
+    }
+
+    constexpr const int128_t& raw() const { return units; }
+
+    friend constexpr bool operator==(const Decimal&, const Decimal&) = default;
+    friend constexpr auto operator<=>(const Decimal& lhs, const Decimal& rhs) { return lhs.units <=> rhs.units; }
+
+    constexpr Decimal operator+() const { return *this; }
+    constexpr Decimal operator-() const { return Decimal() - *this; }
+
+    friend constexpr Decimal operator+(const Decimal& lhs, const Decimal& rhs) {
+        const int128_t sum =
+            static_cast<int128_t>(static_cast<uint128_t>(lhs.units) + static_cast<uint128_t>(rhs.units));
+        // Overflow gives the sum a sign that neither operand has
+        if (((lhs.units ^ sum) & (rhs.units ^ sum)) < 0) {
+            throw std::overflow_error("Decimal overflow");
+        }
+        return fromRaw(sum);
+    }
+
+    friend constexpr Decimal operator-(const Decimal& lhs, const Decimal& rhs) {
+        const int128_t difference =
+            static_cast<int128_t>(static_cast<uint128_t>(lhs.units) - static_cast<uint128_t>(rhs.units));
+        if (((lhs.units ^ rhs.units) & (lhs.units ^ difference)) < 0) {
+            throw std::overflow_error("Decimal overflow");
+        }
+        return fromRaw(difference);
+    }
+
+    friend constexpr Decimal operator*(const Decimal& lhs, const Decimal& rhs) {
+        const detail::decimal::Wide product = detail::decimal::multiply(magnitude(lhs.units), magnitude(rhs.units));
+        return fromWide((lhs.units < 0) != (rhs.units < 0), product, detail::decimal::PowersOf10[Scale],
+                        &detail::decimal::PowerDivider<Scale>);
+    }
+
+    friend constexpr Decimal operator/(const Decimal& lhs, const Decimal& rhs) {
+        if (rhs.units == 0) {
+            throw std::domain_error("Division by zero");
+        }
+        const detail::decimal::Wide dividend =
+            detail::decimal::multiply(magnitude(lhs.units), detail::decimal::PowersOf10[Scale]);
+        return fromWide((lhs.units < 0) != (rhs.units < 0), dividend, magnitude(rhs.units));
+    }
+
+    constexpr Decimal& operator+=(const Decimal& other) { return *this = *this + other; }
+    constexpr Decimal& operator-=(const Decimal& other) { return *this = *this - other; }
+    constexpr Decimal& operator*=(const Decimal& other) { return *this = *this * other; }
+    constexpr Decimal& operator/=(const Decimal& other) { return *this = *this / other; }
+
+  private:
+    template <int OtherScale> friend class Decimal;
+
+    static constexpr uint128_t magnitude(const int128_t& value) {
+        return value < 0 ? uint128_t(0) - static_cast<uint128_t>(value) : static_cast<uint128_t>(value);
+    }
+
+    static constexpr Decimal fromMagnitude(bool negative, const uint128_t& value) {
+        // The negative range has one more value
+        constexpr uint128_t Limit = uint128_t(1) << 127;
+        if (value > Limit - (negative ? 0 : 1)) {
+            throw std::overflow_error("Decimal overflow");
+        }
+        return fromRaw(static_cast<int128_t>(negative ? uint128_t(0) - value : value));
+    }
+
+    static constexpr Decimal fromWide(bool negative, const detail::decimal::Wide& value, const uint128_t& divisor,
+                                      const Divider<uint128_t>* divider = nullptr) {
+        uint128_t quotient = 0;
+        if (!detail::decimal::divideRounded(value, divisor, quotient, divider)) {
+            throw std::overflow_error("Decimal overflow");
+        }
+        return fromMagnitude(negative, quotient);
+    }
+
+    // Multiplies or divides by the power of ten between the scales
+    template <int OtherScale> static constexpr Decimal rescale(const Decimal<OtherScale>& other) {
+        const bool negative = other.units < 0;
+        const uint128_t value = magnitude(other.units);
+        if constexpr (OtherScale <= Scale) {
+            const detail::decimal::Wide product =
+                detail::decimal::multiply(value, detail::decimal::PowersOf10[Scale - OtherScale]);
+            if (product[2] != 0 || product[3] != 0) {
+                throw std::overflow_error("Decimal overflow");
+            }
+            return fromMagnitude(negative, detail::decimal::join(product[1], product[0]));
+        } else {
+            const detail::decimal::Wide wide = {detail::decimal::lowLimb(value), detail::decimal::highLimb(value)};
+            return fromWide(negative, wide, detail::decimal::PowersOf10[OtherScale - Scale],
+                            &detail::decimal::PowerDivider<OtherScale - Scale>);
+        }
+    }
+
+  private:
+    int128_t units = 0;
+};
+
+// Decimal formatting with all Scale fractional digits, like 12.50 or -0.007
+template <int Scale> constexpr std::to_chars_result toChars(char* first, char* last, const Decimal<Scale>& value) {
+    const bool negative = value.raw() < 0;
+    const uint128_t magnitude =
+        negative ? uint128_t(0) - static_cast<uint128_t>(value.raw()) : static_cast<uint128_t>(value.raw());
+
+    char digits[detail::charconv::MaxDigits] = {};
+    const int count = static_cast<int>(toChars(digits, digits + sizeof(digits), magnitude).ptr - digits);
+    const int integerDigits = std::max(count - Scale, 1);
+    const ptrdiff_t size = (negative ? 1 : 0) + integerDigits + (Scale == 0 ? 0 : Scale + 1);
+    if (last - first < size) {
+        return {last, std::errc::value_too_large};
+    }
+
+    char* out = first;
+    if (negative) {
+        *out++ = '-';
+    }
+    if (count > Scale) {
+        out = std::copy(digits, digits + count - Scale, out);
+    } else {
+        *out++ = '0';
+    }
+    if constexpr (Scale != 0) {
+        *out++ = '.';
+        const int fractionDigits = std::min(count, Scale);
+        out = std::fill_n(out, Scale - fractionDigits, '0');
+        out = std::copy(digits + count - fractionDigits, digits + count, out);
+    }
+    return {out, std::errc()};
+}
+
+// Parses an optional minus, digits and an optional fraction, like 12, 12.5 or -.5. Fractional digits past Scale are
+// rounded half to even.
+template <int Scale>
+constexpr std::from_chars_result fromChars(const char* first, const char* last, Decimal<Scale>& value) {
+    const bool negative = first != last && *first == '-';
+    const char* integer = first + (negative ? 1 : 0);
+    const char* integerEnd = detail::charconv::skipDigits(integer, last);
+    const char* fraction = integerEnd;
+    const char* fractionEnd = integerEnd;
+    if (integerEnd != last && *integerEnd == '.') {
+        fraction = integerEnd + 1;
+        fractionEnd = detail::charconv::skipDigits(fraction, last);
+    }
+    if (integer == integerEnd && fraction == fractionEnd) {
+        return {first, std::errc::invalid_argument};
+    }
+
+    const ptrdiff_t fractionDigits = fractionEnd - fraction;
+    const int kept = static_cast<int>(std::min<ptrdiff_t>(fractionDigits, Scale));
+    uint128_t magnitude = 0;
+    bool fits = detail::decimal::appendDigits(magnitude, integer, integerEnd) &&
+                detail::decimal::appendDigits(magnitude, fraction, fraction + kept);
+    for (int padding = Scale - kept; fits && padding > 0; padding -= detail::charconv::ChunkDigits) {
+        const int digits = std::min(padding, detail::charconv::ChunkDigits);
+        fits = detail::decimal::multiplyAdd(magnitude, detail::charconv::PowersOf10[digits], 0);
+    }
+
+    if (fits && fractionDigits > Scale) {
+        const char dropped = fraction[Scale];
+        const bool sticky = std::any_of(fraction + Scale + 1, fractionEnd, [](char digit) { return digit != '0'; });
+        if (dropped > '5' || (dropped == '5' && (sticky || (detail::decimal::lowLimb(magnitude) & 1) != 0))) {
+            fits = detail::decimal::multiplyAdd(magnitude, 1, 1);
+        }
+    }
+
+    constexpr uint128_t Limit = uint128_t(1) << 127;
+    if (!fits || magnitude > Limit - (negative ? 0 : 1)) {
+        return {fractionEnd, std::errc::result_out_of_range};
+    }
+    value = Decimal<Scale>::fromRaw(static_cast<int128_t>(negative ? uint128_t(0) - magnitude : magnitude));
+    return {fractionEnd, std::errc()};
+}
+
+#if __has_include("inline_string.h")
+template <int Scale> constexpr str::InlineString<Decimal<Scale>::maxChars + 1> toChars(const Decimal<Scale>& value) {
+    char buffer[Decimal<Scale>::maxChars];
+    const std::to_chars_result result = toChars(buffer, buffer + sizeof(buffer), value);
+    return std::string_view(buffer, static_cast<size_t>(result.ptr - buffer));
+}
+#endif
+
+} // namespace math
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "int128.h"
+#include "int128_portable.h"
+
+#include <bit>
+#include <concepts>
+#include <span>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CPPUTILS_DIVIDER_SSE2 1
+#endif
+
+namespace math {
+namespace detail {
+namespace divider {
+
+template <typename T> struct Traits;
+
+template <typename T>
+    requires(std::integral<T> && !std::same_as<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8))
+struct Traits<T> {
+    using Unsigned = std::make_unsigned_t<T>;
+    static constexpr bool Signed = std::is_signed_v<T>;
+};
+
+#ifdef CPPUTILS_UINT128
+template <> struct Traits<uint128_t> {
+    using Unsigned = uint128_t;
+    static constexpr bool Signed = false;
+};
+#endif
+
+#if defined(CPPUTILS_INT128) && defined(CPPUTILS_UINT128)
+template <> struct Traits<int128_t> {
+    using Unsigned = uint128_t;
+    static constexpr bool Signed = true;
+};
+#endif
+
+// High half of the double width product
+template <typename U> constexpr U multiplyHigh(U lhs, U rhs) {
+    if constexpr (sizeof(U) == 4) {
+        return static_cast<U>((static_cast<uint64_t>(lhs) * rhs) >> 32);
+    } else if constexpr (sizeof(U) == 8) {
+        uint64_t low = 0;
+        return static_cast<U>(int128::multiplyWide(lhs, rhs, low));
+    } else {
+        const uint64_t lhsLow = static_cast<uint64_t>(lhs);
+        const uint64_t lhsHigh = static_cast<uint64_t>(lhs >> 64);
+        const uint64_t rhsLow = static_cast<uint64_t>(rhs);
+        const uint64_t rhsHigh = static_cast<uint64_t>(rhs >> 64);
+
+        uint64_t lowLow = 0;
+        uint64_t lowHigh = 0;
+        uint64_t highLow = 0;
+        uint64_t highHigh = 0;
+        const uint64_t carryLowLow = int128::multiplyWide(lhsLow, rhsLow, lowLow);
+        const uint64_t carryLowHigh = int128::multiplyWide(lhsLow, rhsHigh, lowHigh);
+        const uint64_t carryHighLow = int128::multiplyWide(lhsHigh, rhsLow, highLow);
+        const uint64_t top = int128::multiplyWide(lhsHigh, rhsHigh, highHigh);
+
+        // The middle column only contributes its carries
+        uint64_t middle = 0;
+        const bool carry1 = int128::addOverflow(carryLowLow, lowHigh, middle);
+        const bool carry2 = int128::addOverflow(middle, highLow, middle);
+        return ((static_cast<U>(top) << 64) | static_cast<U>(highHigh)) + static_cast<U>(carryLowHigh) +
+               static_cast<U>(carryHighLow) + static_cast<U>(carry1) + static_cast<U>(carry2);
+    }
+}
+
+template <typename T, typename U> constexpr T multiplyHighSigned(T lhs, T rhs) {
+    U high = multiplyHigh(static_cast<U>(lhs), static_cast<U>(rhs));
+    if (lhs < 0) {
+        high -= static_cast<U>(rhs);
+    }
+    if (rhs < 0) {
+        high -= static_cast<U>(lhs);
+    }
+    return static_cast<T>(high);
+}
+
+// floor(high * 2^bits / divisor) for high < divisor, only needed to set up a divider
+template <typename U> constexpr U divideWide(U high, U divisor, U& remainder) {
+    if constexpr (sizeof(U) == 4) {
+        const uint64_t dividend = static_cast<uint64_t>(high) << 32;
+        remainder = static_cast<U>(dividend % divisor);
+        return static_cast<U>(dividend / divisor);
+    } else if constexpr (sizeof(U) == 8) {
+        uint64_t rest = 0;
+        const U quotient = static_cast<U>(int128::divideWide(high, 0, divisor, rest));
+        remainder = static_cast<U>(rest);
+        return quotient;
+    } else {
+        // One bit at a time, there is no wider type to lean on
+        U quotient = 0;
+        for (int bit = 0; bit < 128; ++bit) {
+            const bool carry = static_cast<bool>(high >> 127);
+            high <<= 1;
+            quotient <<= 1;
+            if (carry || high >= divisor) {
+                high -= divisor;
+                quotient |= 1;
+            }
+        }
+        remainder = high;
+        return quotient;
+    }
+}
+
+template <typename U> constexpr int floorLog2(U value) {
+    if constexpr (sizeof(U) <= 8) {
+        return std::bit_width(value) - 1;
+    } else {
+        const uint64_t high = static_cast<uint64_t>(value >> 64);
+        return high != 0 ? 127 - std::countl_zero(high) : 63 - std::countl_zero(static_cast<uint64_t>(value));
+    }
+}
+
+#ifdef CPPUTILS_DIVIDER_SSE2
+// High halves of four 32 bit products with the same factor
+inline __m128i multiplyHigh(__m128i values, __m128i factor) {
+    const __m128i even = _mm_srli_epi64(_mm_mul_epu32(values, factor), 32);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(values, 32), factor);
+    return _mm_or_si128(even, _mm_and_si128(odd, _mm_set_epi32(-1, 0, -1, 0)));
+}
+#endif
+
+} // namespace divider
+} // namespace detail
+
+// Division by a divisor that is only known at runtime but used many times, by invariant integers in the style of
+// libdivide. The constructor derives a magic multiplier and a shift once, every division after that is a multiply
+// high, a shift and at most an add, instead of a hardware division that takes tens of cycles.
+// Quotients truncate towards zero and match the builtin division for every dividend.
+template <typename T> class Divider {
+  private:
+    using Traits = detail::divider::Traits<T>;
+    using U = typename Traits::Unsigned;
+
+    static constexpr int Bits = sizeof(T) * 8;
+
+  public:
+    explicit constexpr Divider(T divisor) : divisorValue(divisor) {
+        if (divisor == 0) {
+            throw std::domain_error("Division by zero");
+        }
+
+        negative = Traits::Signed && divisor < 0;
+        const U magnitude = negative ? U(0) - static_cast<U>(divisor) : static_cast<U>(divisor);
+        const int log2 = detail::divider::floorLog2(magnitude);
+
+        // Powers of two are a plain shift
+        if ((magnitude & (magnitude - 1)) == 0) {
+            shift = static_cast<uint8_t>(log2);
+            return;
+        }
+
+        // The smallest magic is 2^(bits + log2) / divisor rounded up, which fits when its rounding error is small
+        // enough. Otherwise the magic needs one more bit, whose multiplication is finished by the add.
+        const int scale = Traits::Signed ? log2 - 1 : log2;
+        U remainder = 0;
+        U proposed = detail::divider::divideWide(U(1) << scale, magnitude, remainder);
+        if (magnitude - remainder < (U(1) << log2)) {
+            shift = static_cast<uint8_t>(scale);
+        } else {
+            proposed += proposed;
+            const U twiceRemainder = remainder + remainder;
+            if (twiceRemainder >= magnitude || twiceRemainder < remainder) {
+                proposed += 1;
+            }
+            shift = static_cast<uint8_t>(log2);
+            add = true;
+        }
+
+        magic = proposed + 1;
+        if (negative) {
+            magic = U(0) - magic;
+        }
+    }
+
+    constexpr T divisor() const { return divisorValue; }
+
+    constexpr T divide(T value) const {
+        if (magic == 0) {
+            return divideShift(value);
+        }
+        return add ? divideMagic<true>(value) : divideMagic<false>(value);
+    }
+
+    constexpr T remainder(T value) const { return static_cast<T>(value - divide(value) * divisorValue); }
+
+    friend constexpr T operator/(T value, const Divider& divider) { return divider.divide(value); }
+    friend constexpr T operator%(T value, const Divider& divider) { return divider.remainder(value); }
+
+    // Divides every value and stores the quotients in the same positions of results, which must be at least as long.
+    // The algorithm is picked once for the whole batch, and 32 bit unsigned values are divided four at a time.
+    void divide(std::span<const T> values, std::span<T> results) const {
+        if (results.size() < values.size()) {
+            throw std::invalid_argument("Results are shorter than the values");
+        }
+
+        size_t i = 0;
+#ifdef CPPUTILS_DIVIDER_SSE2
+        if constexpr (sizeof(T) == 4 && !Traits::Signed) {
+            i = divideSse2(values, results);
+        }
+#endif
+        const auto apply = [&](auto divideOne) {
+            for (; i < values.size(); ++i) {
+                results[i] = divideOne(values[i]);
+            }
+        };
+        if (magic == 0) {
+            apply([this](T value) { return divideShift(value); });
+        } else if (add) {
+            apply([this](T value) { return divideMagic<true>(value); });
+        } else {
+            apply([this](T value) { return divideMagic<false>(value); });
+        }
+    }
+
+  private:
+    constexpr T divideShift(T value) const {
+        if constexpr (Traits::Signed) {
+            // Rounds negative values towards zero by adding divisor - 1 first
+            const U mask = (U(1) << shift) - 1;
+            const U biased = static_cast<U>(value) + (static_cast<U>(value >> (Bits - 1)) & mask);
+            const T quotient = static_cast<T>(biased) >> shift;
+            return negative ? static_cast<T>(U(0) - static_cast<U>(quotient)) : quotient;
+        } else {
+            return value >> shift;
+        }
+    }
+
+    template <bool Add> constexpr T divideMagic(T value) const {
+        if constexpr (Traits::Signed) {
+            U high = static_cast<U>(detail::divider::multiplyHighSigned<T, U>(static_cast<T>(magic), value));
+            if constexpr (Add) {
+                high += negative ? U(0) - static_cast<U>(value) : static_cast<U>(value);
+            }
+            const T quotient = static_cast<T>(high) >> shift;
+            return quotient + (quotient < 0 ? 1 : 0);
+        } else {
+            const U high = detail::divider::multiplyHigh(magic, static_cast<U>(value));
+            if constexpr (Add) {
+                return static_cast<T>((((value - high) >> 1) + high) >> shift);
+            } else {
+                return static_cast<T>(high >> shift);
+            }
+        }
+    }
+
+#ifdef CPPUTILS_DIVIDER_SSE2
+    size_t divideSse2(std::span<const T> values, std::span<T> results) const {
+        const __m128i factor = _mm_set1_epi32(static_cast<int>(magic));
+        const __m128i count = _mm_cvtsi32_si128(shift);
+
+        size_t i = 0;
+        for (; i + 4 <= values.size(); i += 4) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values.data() + i));
+            __m128i quotient;
+            if (magic == 0) {
+                quotient = _mm_srl_epi32(value, count);
+            } else {
+                const __m128i high = detail::divider::multiplyHigh(value, factor);
+                quotient = add ? _mm_add_epi32(_mm_srli_epi32(_mm_sub_epi32(value, high), 1), high) : high;
+                quotient = _mm_srl_epi32(quotient, count);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(results.data() + i), quotient);
+        }
+        return i;
+    }
+#endif
+
+  private:
+    T divisorValue;
+    U magic = 0;
+    uint8_t shift = 0;
+    bool add = false;
+    bool negative = false;
+};
+
+} // namespace math
@@ -0,0 +1,273 @@
+#pragma once
+
+#include "int128.h"
+#include "int128_portable.h"
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <stdint.h>
+#include <string_view>
+#include <system_error>
+
+#if __has_include("inline_string.h")
+#include "inline_string.h"
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CPPUTILS_CHARCONV_SSE2 1
+#endif
+
+namespace math {
+namespace detail {
+namespace charconv {
+
+// A 128 bit value has at most three chunks of 19 digits, the largest power of ten below 2^64
+constexpr uint64_t Chunk = 10000000000000000000u;
+constexpr int ChunkDigits = 19;
+constexpr int128::Reciprocal ChunkReciprocal = int128::makeReciprocal(Chunk);
+
+constexpr std::array<uint64_t, 20> PowersOf10 = [] {
+    std::array<uint64_t, 20> powers{};
+    uint64_t power = 1;
+    for (uint64_t& entry : powers) {
+        entry = power;
+        power *= 10;
+    }
+    return powers;
+}();
+
+constexpr std::array<char, 200> DigitPairs = [] {
+    std::array<char, 200> pairs{};
+    for (int i = 0; i < 100; ++i) {
+        pairs[2 * i] = static_cast<char>('0' + i / 10);
+        pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+    return pairs;
+}();
+
+// The largest magnitudes, all of them have 39 digits
+constexpr std::string_view MaxUnsigned = "340282366920938463463374607431768211455";
+constexpr std::string_view MaxSigned = "170141183460469231731687303715884105727";
+constexpr std::string_view MinSigned = "170141183460469231731687303715884105728";
+constexpr int MaxDigits = 39;
+
+constexpr int countDigits(uint64_t value) {
+    if (value == 0) {
+        return 1;
+    }
+    // log10(2) is about 1233 / 4096, which can be one short
+    const int estimate = (std::bit_width(value) * 1233) >> 12;
+    return estimate + (value >= PowersOf10[estimate] ? 1 : 0);
+}
+
+constexpr void writePair(char* out, uint32_t value) {
+    out[0] = DigitPairs[2 * value];
+    out[1] = DigitPairs[2 * value + 1];
+}
+
+// Exactly eight digits with leading zeros
+constexpr void writeEight(char* out, uint32_t value) {
+    const uint32_t high = value / 10000;
+    const uint32_t low = value % 10000;
+    writePair(out, high / 100);
+    writePair(out + 2, high % 100);
+    writePair(out + 4, low / 100);
+    writePair(out + 6, low % 100);
+}
+
+// Exactly 19 digits with leading zeros, split so that most of the work is 32 bit
+constexpr void writeChunk(char* out, uint64_t value) {
+    const uint32_t top = static_cast<uint32_t>(value / 10000000000000000u);
+    const uint64_t rest = value % 10000000000000000u;
+    out[0] = static_cast<char>('0' + top / 100);
+    writePair(out + 1, top % 100);
+    writeEight(out + 3, static_cast<uint32_t>(rest / 100000000));
+    writeEight(out + 11, static_cast<uint32_t>(rest % 100000000));
+}
+
+// The given number of digits of the value without leading zeros
+constexpr void writeDigits(char* out, uint64_t value, int digits) {
+    char* end = out + digits;
+    while (value >= 100) {
+        end -= 2;
+        writePair(end, static_cast<uint32_t>(value % 100));
+        value /= 100;
+    }
+    if (value >= 10) {
+        writePair(end - 2, static_cast<uint32_t>(value));
+    } else {
+        end[-1] = static_cast<char>('0' + value);
+    }
+}
+
+constexpr std::to_chars_result writeUnsigned(char* first, char* last, uint64_t high, uint64_t low) {
+    if (high == 0) {
+        const int digits = countDigits(low);
+        if (last - first < digits) {
+            return {last, std::errc::value_too_large};
+        }
+        writeDigits(first, low, digits);
+        return {first + digits, std::errc()};
+    }
+
+    // value / 10^19 keeps a quotient of up to 65 bits, which a second step splits again
+    uint64_t chunks[2] = {};
+    const uint64_t carry = high >= Chunk ? 1 : 0;
+    const uint64_t quotient = int128::divideWide(high - carry * Chunk, low, ChunkReciprocal, chunks[1]);
+    uint64_t top = quotient;
+    int count = 1;
+    if (carry != 0 || quotient >= Chunk) {
+        top = int128::divideWide(carry, quotient, ChunkReciprocal, chunks[0]);
+        count = 2;
+    }
+
+    const int topDigits = countDigits(top);
+    const int digits = topDigits + count * ChunkDigits;
+    if (last - first < digits) {
+        return {last, std::errc::value_too_large};
+    }
+    writeDigits(first, top, topDigits);
+    char* out = first + topDigits;
+    for (int i = 2 - count; i < 2; ++i, out += ChunkDigits) {
+        writeChunk(out, chunks[i]);
+    }
+    return {out, std::errc()};
+}
+
+// End of the run of decimal digits that starts at first, sixteen characters at a time where possible
+constexpr const char* skipDigits(const char* first, const char* last) {
+#ifdef CPPUTILS_CHARCONV_SSE2
+    if (!std::is_constant_evaluated()) {
+        const __m128i zero = _mm_set1_epi8('0');
+        const __m128i nine = _mm_set1_epi8(9);
+        while (last - first >= 16) {
+            const __m128i digits = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), zero);
+            const __m128i valid = _mm_cmpeq_epi8(_mm_min_epu8(digits, nine), digits);
+            const unsigned invalid = ~static_cast<unsigned>(_mm_movemask_epi8(valid)) & 0xffff;
+            if (invalid != 0) {
+                return first + std::countr_zero(invalid);
+            }
+            first += 16;
+        }
+    }
+#endif
+    while (first != last && static_cast<unsigned char>(*first - '0') <= 9) {
+        ++first;
+    }
+    return first;
+}
+
+// Eight digits in a handful of multiplications, the first digit is the most significant
+constexpr uint32_t parseEight(const char* digits) {
+    uint64_t word = 0;
+    for (int i = 0; i < 8; ++i) {
+        word |= static_cast<uint64_t>(static_cast<unsigned char>(digits[i])) << (8 * i);
+    }
+    word -= 0x3030303030303030;
+    word = (word * 10 + (word >> 8)) & 0x00ff00ff00ff00ff;
+    word = (word * 100 + (word >> 16)) & 0x0000ffff0000ffff;
+    return static_cast<uint32_t>((word * 10000 + (word >> 32)) & 0xffffffff);
+}
+
+constexpr uint64_t parseChunk(const char* digits, int count) {
+    uint64_t value = 0;
+    for (; count >= 8; count -= 8, digits += 8) {
+        value = value * 100000000 + parseEight(digits);
+    }
+    for (; count > 0; --count, ++digits) {
+        value = value * 10 + static_cast<uint64_t>(*digits - '0');
+    }
+    return value;
+}
+
+// Parses the digits of a magnitude that is at most limit, which has as many digits as the largest value
+template <typename U>
+constexpr std::from_chars_result parseUnsigned(const char* first, const char* last, std::string_view limit,
+                                               U& magnitude) {
+    const char* end = skipDigits(first, last);
+    if (end == first) {
+        return {first, std::errc::invalid_argument};
+    }
+
+    const char* digits = first;
+    while (digits != end && *digits == '0') {
+        ++digits;
+    }
+    const int count = static_cast<int>(end - digits);
+    if (count > MaxDigits || (count == MaxDigits && std::string_view(digits, MaxDigits) > limit)) {
+        return {end, std::errc::result_out_of_range};
+    }
+
+    U value = 0;
+    int chunk = count % ChunkDigits;
+    if (chunk == 0) {
+        chunk = ChunkDigits;
+    }
+    for (; digits != end; digits += chunk, chunk = ChunkDigits) {
+        value = value * U(PowersOf10[chunk]) + U(parseChunk(digits, chunk));
+    }
+    magnitude = value;
+    return {end, std::errc()};
+}
+
+} // namespace charconv
+} // namespace detail
+
+// Decimal formatting and parsing of the 128 bit integers, with the semantics of std::to_chars and std::from_chars in
+// base 10, which the standard library does not offer for these types. The value is split into 64 bit chunks of 19
+// digits, so all digit work is 64 bit or narrower.
+
+constexpr std::to_chars_result toChars(char* first, char* last, uint128_t value) {
+    return detail::charconv::writeUnsigned(first, last, static_cast<uint64_t>(value >> 64),
+                                           static_cast<uint64_t>(value));
+}
+
+constexpr std::to_chars_result toChars(char* first, char* last, int128_t value) {
+    uint128_t magnitude = static_cast<uint128_t>(value);
+    if (value < 0) {
+        if (first == last) {
+            return {last, std::errc::value_too_large};
+        }
+        *first++ = '-';
+        magnitude = uint128_t(0) - magnitude;
+    }
+    return toChars(first, last, magnitude);
+}
+
+constexpr std::from_chars_result fromChars(const char* first, const char* last, uint128_t& value) {
+    return detail::charconv::parseUnsigned(first, last, detail::charconv::MaxUnsigned, value);
+}
+
+constexpr std::from_chars_result fromChars(const char* first, const char* last, int128_t& value) {
+    const bool negative = first != last && *first == '-';
+    uint128_t magnitude = 0;
+    const std::from_chars_result result = detail::charconv::parseUnsigned(
+        first + (negative ? 1 : 0), last, negative ? detail::charconv::MinSigned : detail::charconv::MaxSigned,
+        magnitude);
+    if (result.ec == std::errc::invalid_argument) {
+        return {first, result.ec};
+    }
+    if (result.ec == std::errc()) {
+        value = static_cast<int128_t>(negative ? uint128_t(0) - magnitude : magnitude);
+    }
+    return result;
+}
+
+#if __has_include("inline_string.h")
+// The decimal digits in a string without allocation, sized for the longest value including the terminator
+constexpr str::InlineString<40> toChars(uint128_t value) {
+    char buffer[detail::charconv::MaxDigits];
+    const std::to_chars_result result = toChars(buffer, buffer + sizeof(buffer), value);
+    return std::string_view(buffer, static_cast<size_t>(result.ptr - buffer));
+}
+
+constexpr str::InlineString<41> toChars(int128_t value) {
+    char buffer[detail::charconv::MaxDigits + 1];
+    const std::to_chars_result result = toChars(buffer, buffer + sizeof(buffer), value);
+    return std::string_view(buffer, static_cast<size_t>(result.ptr - buffer));
+}
+#endif
+
+} // namespace math
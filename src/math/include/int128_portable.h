@@ -0,0 +1,536 @@
+#pragma once
+
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#define CPPUTILS_INT128_MSVC_INTRINSICS 1
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define CPPUTILS_INT128_X86_ASM 1
+#endif
+
+namespace math {
+namespace detail {
+namespace int128 {
+
+constexpr bool addOverflow(uint64_t lhs, uint64_t rhs, uint64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_add_overflow(lhs, rhs, &result);
+#else
+#if defined(CPPUTILS_INT128_MSVC_INTRINSICS) && defined(_M_X64)
+    if (!std::is_constant_evaluated()) {
+        return _addcarry_u64(0, lhs, rhs, &result) != 0;
+    }
+#endif
+    result = lhs + rhs;
+    return result < lhs;
+#endif
+}
+
+constexpr bool subOverflow(uint64_t lhs, uint64_t rhs, uint64_t& result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_sub_overflow(lhs, rhs, &result);
+#else
+#if defined(CPPUTILS_INT128_MSVC_INTRINSICS) && defined(_M_X64)
+    if (!std::is_constant_evaluated()) {
+        return _subborrow_u64(0, lhs, rhs, &result) != 0;
+    }
+#endif
+    result = lhs - rhs;
+    return lhs < rhs;
+#endif
+}
+
+// Full 128 bit product, returns the high half
+constexpr uint64_t multiplyWide(uint64_t lhs, uint64_t rhs, uint64_t& low) {
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+    low = static_cast<uint64_t>(product);
+    return static_cast<uint64_t>(product >> 64);
+#else
+#if defined(CPPUTILS_INT128_MSVC_INTRINSICS)
+    if (!std::is_constant_evaluated()) {
+#if defined(_M_X64)
+        uint64_t high = 0;
+        low = _umul128(lhs, rhs, &high);
+        return high;
+#else
+        low = lhs * rhs;
+        return __umulh(lhs, rhs);
+#endif
+    }
+#endif
+    const uint64_t lhsLow = lhs & 0xffffffff;
+    const uint64_t lhsHigh = lhs >> 32;
+    const uint64_t rhsLow = rhs & 0xffffffff;
+    const uint64_t rhsHigh = rhs >> 32;
+
+    const uint64_t lowLow = lhsLow * rhsLow;
+    const uint64_t highLow = lhsHigh * rhsLow;
+    const uint64_t lowHigh = lhsLow * rhsHigh;
+    const uint64_t middle = (lowLow >> 32) + (highLow & 0xffffffff) + lowHigh;
+
+    low = (middle << 32) | (lowLow & 0xffffffff);
+    return lhsHigh * rhsHigh + (highLow >> 32) + (middle >> 32);
+#endif
+}
+
+// Knuth's algorithm D with 32 bit digits, after divlu in Hacker's Delight. The fallback of divideWide, which only
+// runs on targets without a 128 by 64 bit division instruction and in constant evaluation.
+constexpr uint64_t divideWidePortable(uint64_t high, uint64_t low, uint64_t divisor, uint64_t& remainder) {
+    constexpr uint64_t Base = uint64_t(1) << 32;
+
+    const int shift = std::countl_zero(divisor);
+    divisor <<= shift;
+    const uint64_t top = shift == 0 ? high : (high << shift) | (low >> (64 - shift));
+    low <<= shift;
+
+    const uint64_t divisorHigh = divisor >> 32;
+    const uint64_t divisorLow = divisor & 0xffffffff;
+    const uint64_t lowHigh = low >> 32;
+    const uint64_t lowLow = low & 0xffffffff;
+
+    uint64_t quotientHigh = top / divisorHigh;
+    uint64_t estimate = top - quotientHigh * divisorHigh;
+    while (quotientHigh >= Base || quotientHigh * divisorLow > Base * estimate + lowHigh) {
+        --quotientHigh;
+        estimate += divisorHigh;
+        if (estimate >= Base) {
+            break;
+        }
+    }
+
+    const uint64_t middle = top * Base + lowHigh - quotientHigh * divisor;
+    uint64_t quotientLow = middle / divisorHigh;
+    estimate = middle - quotientLow * divisorHigh;
+    while (quotientLow >= Base || quotientLow * divisorLow > Base * estimate + lowLow) {
+        --quotientLow;
+        estimate += divisorHigh;
+        if (estimate >= Base) {
+            break;
+        }
+    }
+
+    remainder = (middle * Base + lowLow - quotientLow * divisor) >> shift;
+    return quotientHigh * Base + quotientLow;
+}
+
+// Divides high:low by divisor, the quotient has to fit in 64 bits, that is high < divisor
+constexpr uint64_t divideWide(uint64_t high, uint64_t low, uint64_t divisor, uint64_t& remainder) {
+    if (!std::is_constant_evaluated()) {
+#if defined(CPPUTILS_INT128_MSVC_INTRINSICS) && defined(_M_X64) && _MSC_VER >= 1920
+        return _udiv128(high, low, divisor, &remainder);
+#elif defined(CPPUTILS_INT128_X86_ASM)
+        uint64_t quotient = 0;
+        __asm__("divq %[divisor]" : "=a"(quotient), "=d"(remainder) : [divisor] "r"(divisor), "a"(low), "d"(high));
+        return quotient;
+#endif
+    }
+    return divideWidePortable(high, low, divisor, remainder);
+}
+
+// Reciprocal of a 64 bit divisor for Möller and Granlund's division by invariant integers, which replaces the division
+// instruction by two multiplications. Pays off when many values are divided by the same divisor.
+struct Reciprocal {
+    // Shifted so that its top bit is set
+    uint64_t divisor;
+    // floor((2^128 - 1) / divisor) - 2^64
+    uint64_t value;
+    int shift;
+};
+
+constexpr Reciprocal makeReciprocal(uint64_t divisor) {
+    if (divisor == 0) {
+        throw std::domain_error("Division by zero");
+    }
+    const int shift = std::countl_zero(divisor);
+    const uint64_t normalized = divisor << shift;
+    uint64_t remainder = 0;
+    return {normalized, divideWide(~normalized, ~uint64_t(0), normalized, remainder), shift};
+}
+
+// Divides high:low by the divisor of the reciprocal, high has to be smaller than that divisor. Algorithm 4 of
+// "Improved division by invariant integers", Möller and Granlund 2011.
+constexpr uint64_t divideWide(uint64_t high, uint64_t low, const Reciprocal& reciprocal, uint64_t& remainder) {
+    if (reciprocal.shift != 0) {
+        high = (high << reciprocal.shift) | (low >> (64 - reciprocal.shift));
+        low <<= reciprocal.shift;
+    }
+
+    uint64_t estimateLow = 0;
+    uint64_t quotient = multiplyWide(reciprocal.value, high, estimateLow);
+    const bool carry = addOverflow(estimateLow, low, estimateLow);
+    quotient += high + carry + 1;
+
+    uint64_t rest = low - quotient * reciprocal.divisor;
+    if (rest > estimateLow) {
+        --quotient;
+        rest += reciprocal.divisor;
+    }
+    if (rest >= reciprocal.divisor) {
+        ++quotient;
+        rest -= reciprocal.divisor;
+    }
+
+    remainder = rest >> reciprocal.shift;
+    return quotient;
+}
+
+// The limbs of a 128 bit value, for kernels shared by the portable and the builtin types
+struct Limbs {
+    uint64_t high;
+    uint64_t low;
+};
+
+struct LimbsDivision {
+    Limbs quotient;
+    Limbs remainder;
+};
+
+constexpr bool lessLimbs(const Limbs& lhs, const Limbs& rhs) {
+    return lhs.high < rhs.high || (lhs.high == rhs.high && lhs.low < rhs.low);
+}
+
+constexpr Limbs subtractLimbs(const Limbs& lhs, const Limbs& rhs) {
+    uint64_t low = 0;
+    const bool borrow = subOverflow(lhs.low, rhs.low, low);
+    return {lhs.high - rhs.high - borrow, low};
+}
+
+constexpr Limbs negateLimbs(const Limbs& value) { return subtractLimbs({0, 0}, value); }
+
+// Unsigned 128 bit division, quotient and remainder in one pass
+constexpr LimbsDivision divideLimbs(const Limbs& dividend, const Limbs& divisor) {
+    if (divisor.high == 0) {
+        if (divisor.low == 0) {
+            throw std::domain_error("Division by zero");
+        }
+        if (dividend.high == 0) {
+            return {{0, dividend.low / divisor.low}, {0, dividend.low % divisor.low}};
+        }
+
+        // A 64 bit division for the high limb of the quotient if it has one, then a 128 by 64 bit division
+        uint64_t quotientHigh = 0;
+        uint64_t top = dividend.high;
+        if (top >= divisor.low) {
+            quotientHigh = top / divisor.low;
+            top %= divisor.low;
+        }
+        uint64_t remainder = 0;
+        const uint64_t quotientLow = divideWide(top, dividend.low, divisor.low, remainder);
+        return {{quotientHigh, quotientLow}, {0, remainder}};
+    }
+    if (lessLimbs(dividend, divisor)) {
+        return {{0, 0}, dividend};
+    }
+
+    // Knuth's algorithm D for a two limb divisor, which leaves a single limb quotient. Dividing half the dividend by
+    // the top limb of the normalized divisor gives an estimate that is at most one too large once the normalization is
+    // undone and one is subtracted, after divlu64 in Hacker's Delight.
+    const int shift = std::countl_zero(divisor.high);
+    const uint64_t normalized = shift == 0 ? divisor.high : (divisor.high << shift) | (divisor.low >> (64 - shift));
+
+    uint64_t rest = 0;
+    uint64_t quotient = divideWide(dividend.high >> 1, (dividend.low >> 1) | (dividend.high << 63), normalized, rest);
+    quotient >>= 63 - shift;
+    if (quotient != 0) {
+        --quotient;
+    }
+
+    uint64_t productLow = 0;
+    const uint64_t productHigh = multiplyWide(quotient, divisor.low, productLow) + quotient * divisor.high;
+    Limbs remainder = subtractLimbs(dividend, {productHigh, productLow});
+    if (!lessLimbs(remainder, divisor)) {
+        ++quotient;
+        remainder = subtractLimbs(remainder, divisor);
+    }
+    return {{0, quotient}, remainder};
+}
+
+// Signed 128 bit division on two's complement limbs, truncating towards zero like the builtin division
+constexpr LimbsDivision divideLimbsSigned(const Limbs& dividend, const Limbs& divisor) {
+    const bool negativeDividend = static_cast<int64_t>(dividend.high) < 0;
+    const bool negativeDivisor = static_cast<int64_t>(divisor.high) < 0;
+
+    LimbsDivision result = divideLimbs(negativeDividend ? negateLimbs(dividend) : dividend,
+                                       negativeDivisor ? negateLimbs(divisor) : divisor);
+    if (negativeDividend != negativeDivisor) {
+        result.quotient = negateLimbs(result.quotient);
+    }
+    if (negativeDividend) {
+        result.remainder = negateLimbs(result.remainder);
+    }
+    return result;
+}
+
+} // namespace int128
+} // namespace detail
+
+// 128 bit integer made of two 64 bit limbs, for compilers without a builtin 128 bit type. It behaves like the builtin
+// types: arithmetic wraps, division truncates towards zero and conversions to narrower integers keep the low bits.
+// Division by zero throws std::domain_error. The low limb comes first, matching the layout of the builtin types on
+// little endian targets.
+template <bool Signed> class BasicInt128 {
+  private:
+    using Unsigned = BasicInt128<false>;
+
+  public:
+    constexpr BasicInt128() noexcept = default;
+
+    template <std::integral T>
+    constexpr BasicInt128(T value) noexcept : low(static_cast<uint64_t>(value)), high(signBits(value)) {}
+
+    template <bool OtherSigned>
+        requires(OtherSigned != Signed)
+    explicit constexpr BasicInt128(const BasicInt128<OtherSigned>& other) noexcept
+        : low(other.lowBits()), high(other.highBits()) {}
+
+    template <std::floating_point T> explicit constexpr BasicInt128(T value) noexcept {
+        const bool negative = value < 0;
+        const T magnitude = negative ? -value : value;
+        constexpr T LimbScale = static_cast<T>(18446744073709551616.0);
+        high = static_cast<uint64_t>(magnitude / LimbScale);
+        low = static_cast<uint64_t>(magnitude - static_cast<T>(high) * LimbScale);
+        if (negative) {
+            *this = -*this;
+        }
+    }
+
+    static constexpr BasicInt128 fromBits(uint64_t high, uint64_t low) noexcept {
+        BasicInt128 result;
+        result.high = high;
+        result.low = low;
+        return result;
+    }
+
+    constexpr uint64_t lowBits() const noexcept { return low; }
+    constexpr uint64_t highBits() const noexcept { return high; }
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    explicit constexpr operator T() const noexcept {
+        return static_cast<T>(low);
+    }
+
+    explicit constexpr operator bool() const noexcept { return (low | high) != 0; }
+
+    template <std::floating_point T> explicit constexpr operator T() const noexcept {
+        if (isNegative()) {
+            return -static_cast<T>(Unsigned(-*this));
+        }
+        return static_cast<T>(high) * static_cast<T>(18446744073709551616.0) + static_cast<T>(low);
+    }
+
+    friend constexpr bool operator==(const BasicInt128&, const BasicInt128&) noexcept = default;
+
+    friend constexpr std::strong_ordering operator<=>(const BasicInt128& lhs, const BasicInt128& rhs) noexcept {
+        if (lhs.high != rhs.high) {
+            if constexpr (Signed) {
+                return static_cast<int64_t>(lhs.high) <=> static_cast<int64_t>(rhs.high);
+            } else {
+                return lhs.high <=> rhs.high;
+            }
+        }
+        return lhs.low <=> rhs.low;
+    }
+
+    constexpr BasicInt128 operator+() const noexcept { return *this; }
+    constexpr BasicInt128 operator-() const noexcept { return BasicInt128() - *this; }
+    constexpr BasicInt128 operator~() const noexcept { return fromBits(~high, ~low); }
+    constexpr bool operator!() const noexcept { return !static_cast<bool>(*this); }
+
+    friend constexpr BasicInt128 operator+(const BasicInt128& lhs, const BasicInt128& rhs) noexcept {
+        uint64_t low = 0;
+        const bool carry = detail::int128::addOverflow(lhs.low, rhs.low, low);
+        return fromBits(lhs.high + rhs.high + carry, low);
+    }
+
+    friend constexpr BasicInt128 operator-(const BasicInt128& lhs, const BasicInt128& rhs) noexcept {
+        uint64_t low = 0;
+        const bool borrow = detail::int128::subOverflow(lhs.low, rhs.low, low);
+        return fromBits(lhs.high - rhs.high - borrow, low);
+    }
+
+    // The low 128 bits of the product are the same for signed and unsigned operands
+    friend constexpr BasicInt128 operator*(const BasicInt128& lhs, const BasicInt128& rhs) noexcept {
+        uint64_t low = 0;
+        const uint64_t high = detail::int128::multiplyWide(lhs.low, rhs.low, low);
+        return fromBits(high + lhs.low * rhs.high + lhs.high * rhs.low, low);
+    }
+
+    friend constexpr BasicInt128 operator/(const BasicInt128& lhs, const BasicInt128& rhs) {
+        const detail::int128::Limbs quotient = divide(lhs, rhs).quotient;
+        return fromBits(quotient.high, quotient.low);
+    }
+
+    friend constexpr BasicInt128 operator%(const BasicInt128& lhs, const BasicInt128& rhs) {
+        const detail::int128::Limbs remainder = divide(lhs, rhs).remainder;
+        return fromBits(remainder.high, remainder.low);
+    }
+
+    friend constexpr BasicInt128 operator&(const BasicInt128& lhs, const BasicInt128& rhs) noexcept {
+        return fromBits(lhs.high & rhs.high, lhs.low & rhs.low);
+    }
+
+    friend constexpr BasicInt128 operator|(const BasicInt128& lhs, const BasicInt128& rhs) noexcept {
+        return fromBits(lhs.high | rhs.high, lhs.low | rhs.low);
+    }
+
+    friend constexpr BasicInt128 operator^(const BasicInt128& lhs, const BasicInt128& rhs) noexcept {
+        return fromBits(lhs.high ^ rhs.high, lhs.low ^ rhs.low);
+    }
+
+    // Like the builtin shifts, the count has to be below 128
+    template <std::integral T> friend constexpr BasicInt128 operator<<(const BasicInt128& value, T count) noexcept {
+        const unsigned shift = static_cast<unsigned>(count);
+        if (shift >= 64) {
+            return fromBits(value.low << (shift - 64), 0);
+        }
+        if (shift == 0) {
+            return value;
+        }
+        return fromBits((value.high << shift) | (value.low >> (64 - shift)), value.low << shift);
+    }
+
+    // Arithmetic for signed values, logical for unsigned ones
+    template <std::integral T> friend constexpr BasicInt128 operator>>(const BasicInt128& value, T count) noexcept {
+        const unsigned shift = static_cast<unsigned>(count);
+        const uint64_t fill = Signed && value.isNegative() ? ~uint64_t(0) : 0;
+        if (shift >= 64) {
+            const uint64_t low = shift == 64 ? value.high : (value.high >> (shift - 64)) | (fill << (128 - shift));
+            return fromBits(fill, low);
+        }
+        if (shift == 0) {
+            return value;
+        }
+        return fromBits((value.high >> shift) | (fill << (64 - shift)),
+                        (value.low >> shift) | (value.high << (64 - shift)));
+    }
+
+    template <bool CountSigned>
+    friend constexpr BasicInt128 operator<<(const BasicInt128& value, const BasicInt128<CountSigned>& count) noexcept {
+        return value << count.lowBits();
+    }
+
+    template <bool CountSigned>
+    friend constexpr BasicInt128 operator>>(const BasicInt128& value, const BasicInt128<CountSigned>& count) noexcept {
+        return value >> count.lowBits();
+    }
+
+    constexpr BasicInt128& operator+=(const BasicInt128& other) noexcept { return *this = *this + other; }
+    constexpr BasicInt128& operator-=(const BasicInt128& other) noexcept { return *this = *this - other; }
+    constexpr BasicInt128& operator*=(const BasicInt128& other) noexcept { return *this = *this * other; }
+    constexpr BasicInt128& operator/=(const BasicInt128& other) { return *this = *this / other; }
+    constexpr BasicInt128& operator%=(const BasicInt128& other) { return *this = *this % other; }
+    constexpr BasicInt128& operator&=(const BasicInt128& other) noexcept { return *this = *this & other; }
+    constexpr BasicInt128& operator|=(const BasicInt128& other) noexcept { return *this = *this | other; }
+    constexpr BasicInt128& operator^=(const BasicInt128& other) noexcept { return *this = *this ^ other; }
+    template <std::integral T> constexpr BasicInt128& operator<<=(T count) noexcept { return *this = *this << count; }
+    template <std::integral T> constexpr BasicInt128& operator>>=(T count) noexcept { return *this = *this >> count; }
+    template <bool CountSigned> constexpr BasicInt128& operator<<=(const BasicInt128<CountSigned>& count) noexcept {
+        return *this = *this << count;
+    }
+    template <bool CountSigned> constexpr BasicInt128& operator>>=(const BasicInt128<CountSigned>& count) noexcept {
+        return *this = *this >> count;
+    }
+
+    constexpr BasicInt128& operator++() noexcept { return *this += 1; }
+    constexpr BasicInt128& operator--() noexcept { return *this -= 1; }
+
+    constexpr BasicInt128 operator++(int) noexcept {
+        const BasicInt128 previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    constexpr BasicInt128 operator--(int) noexcept {
+        const BasicInt128 previous = *this;
+        --*this;
+        return previous;
+    }
+
+  private:
+    template <std::integral T> static constexpr uint64_t signBits(T value) noexcept {
+        if constexpr (std::is_signed_v<T>) {
+            return value < 0 ? ~uint64_t(0) : 0;
+        } else {
+            return 0;
+        }
+    }
+
+    constexpr bool isNegative() const noexcept { return Signed && static_cast<int64_t>(high) < 0; }
+
+    static constexpr detail::int128::LimbsDivision divide(const BasicInt128& dividend, const BasicInt128& divisor) {
+        const detail::int128::Limbs lhs{dividend.high, dividend.low};
+        const detail::int128::Limbs rhs{divisor.high, divisor.low};
+        return Signed ? detail::int128::divideLimbsSigned(lhs, rhs) : detail::int128::divideLimbs(lhs, rhs);
+    }
+
+  private:
+    uint64_t low = 0;
+    uint64_t high = 0;
+};
+
+using Int128 = BasicInt128<true>;
+using UInt128 = BasicInt128<false>;
+
+template <typename T> struct DivMod {
+    T quotient;
+    T remainder;
+};
+
+// Quotient and remainder of a 128 bit division in one pass, for the portable types as well as the builtin ones
+template <typename T>
+    requires(sizeof(T) == 16)
+constexpr DivMod<T> divmod(const T& dividend, const T& divisor) {
+    const auto toLimbs = [](const T& value) {
+        return detail::int128::Limbs{static_cast<uint64_t>(value >> 64), static_cast<uint64_t>(value)};
+    };
+    const auto fromLimbs = [](const detail::int128::Limbs& limbs) {
+        return static_cast<T>((static_cast<T>(limbs.high) << 64) | static_cast<T>(limbs.low));
+    };
+
+    const detail::int128::LimbsDivision result =
+        T(-1) < T(0) ? detail::int128::divideLimbsSigned(toLimbs(dividend), toLimbs(divisor))
+                     : detail::int128::divideLimbs(toLimbs(dividend), toLimbs(divisor));
+    return {fromLimbs(result.quotient), fromLimbs(result.remainder)};
+}
+
+} // namespace math
+
+namespace std {
+
+template <bool Signed> struct numeric_limits<math::BasicInt128<Signed>> {
+  private:
+    using T = math::BasicInt128<Signed>;
+
+  public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = Signed;
+    static constexpr bool is_integer = true;
+    static constexpr bool is_exact = true;
+    static constexpr bool has_infinity = false;
+    static constexpr bool has_quiet_NaN = false;
+    static constexpr bool has_signaling_NaN = false;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = !Signed;
+    static constexpr int digits = Signed ? 127 : 128;
+    static constexpr int digits10 = 38;
+    static constexpr int radix = 2;
+
+    static constexpr T min() noexcept { return Signed ? T::fromBits(uint64_t(1) << 63, 0) : T(); }
+    static constexpr T lowest() noexcept { return min(); }
+    static constexpr T max() noexcept {
+        return Signed ? T::fromBits(~uint64_t(0) >> 1, ~uint64_t(0)) : T::fromBits(~uint64_t(0), ~uint64_t(0));
+    }
+};
+
+} // namespace std
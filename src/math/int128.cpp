@@ -1,50 +1,39 @@
 #include "int128.h"
 
-// Workaround for clang-cl
+// Workaround for clang-cl, which has the builtin 128 bit types but links against a runtime without their division
+// routines. Each routine is a single pass of the limb kernels, the combined ones hand out both results.
 #ifdef CPPUTILS_MSVC_INT128
-#include <__msvc_int128.hpp>
-
-namespace {
-template <typename TBuiltin, typename TStruct> [[maybe_unused]] TBuiltin divti3(TBuiltin lhs, TBuiltin rhs) {
-    TStruct value(static_cast<uint64_t>(lhs), static_cast<uint64_t>(lhs >> 64));
-    value /= TStruct(static_cast<uint64_t>(rhs), static_cast<uint64_t>(rhs >> 64));
-
-    uint64_t low = static_cast<uint64_t>(value);
-    uint64_t high = static_cast<uint64_t>(value >> 64);
-
-    uint128_t result = low | (static_cast<uint128_t>(high) << 64);
-    return static_cast<TBuiltin>(result);
-}
-
-template <typename TBuiltin, typename TStruct> [[maybe_unused]] TBuiltin modti3(TBuiltin lhs, TBuiltin rhs) {
-    TStruct value(static_cast<uint64_t>(lhs), static_cast<uint64_t>(lhs >> 64));
-    value %= TStruct(static_cast<uint64_t>(rhs), static_cast<uint64_t>(rhs >> 64));
-
-    uint64_t low = static_cast<uint64_t>(value);
-    uint64_t high = static_cast<uint64_t>(value >> 64);
-
-    uint128_t result = low | (static_cast<uint128_t>(high) << 64);
-    return static_cast<TBuiltin>(result);
-}
-} // namespace
+#include "int128_portable.h"
 
 #ifdef CPPUTILS_INT128_BUILTIN
 extern "C" int128_t __divti3(int128_t lhs, int128_t rhs) {
-    return divti3<int128_t, std::_Signed128>(lhs, rhs);
+    return math::divmod(lhs, rhs).quotient;
 }
 
 extern "C" int128_t __modti3(int128_t lhs, int128_t rhs) {
-    return modti3<int128_t, std::_Signed128>(lhs, rhs);
+    return math::divmod(lhs, rhs).remainder;
+}
+
+extern "C" int128_t __divmodti4(int128_t lhs, int128_t rhs, int128_t* remainder) {
+    const math::DivMod<int128_t> result = math::divmod(lhs, rhs);
+    *remainder = result.remainder;
+    return result.quotient;
 }
 #endif
 
 #ifdef CPPUTILS_UINT128_BUILTIN
 extern "C" uint128_t __udivti3(uint128_t lhs, uint128_t rhs) {
-    return divti3<uint128_t, std::_Unsigned128>(lhs, rhs);
+    return math::divmod(lhs, rhs).quotient;
 }
 
 extern "C" uint128_t __umodti3(uint128_t lhs, uint128_t rhs) {
-    return modti3<uint128_t, std::_Unsigned128>(lhs, rhs);
+    return math::divmod(lhs, rhs).remainder;
+}
+
+extern "C" uint128_t __udivmodti4(uint128_t lhs, uint128_t rhs, uint128_t* remainder) {
+    const math::DivMod<uint128_t> result = math::divmod(lhs, rhs);
+    *remainder = result.remainder;
+    return result.quotient;
 }
 #endif
 
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+namespace memory {
+namespace detail {
+namespace epoch {
+
+struct Retired {
+    void* pointer;
+    void (*deleter)(void*);
+    uint64_t epoch;
+};
+
+// One per thread, recycled when the thread exits
+struct Record {
+    // Announced epoch shifted left by one, the low bit is set while the thread is inside a guard
+    std::atomic<uint64_t> state{0};
+    std::atomic<bool> owned{true};
+    // Set before the record is published and never changed
+    Record* next = nullptr;
+
+    // Only touched by the owning thread
+    unsigned depth = 0;
+    size_t retiredSinceCollect = 0;
+    std::vector<Retired> retired;
+};
+
+// Objects retired in epoch e are freed once the global epoch reaches e + 2. The epoch only advances when every thread
+// inside a guard has announced the current one, so by then no guard that could have seen the object is left.
+class Domain {
+  public:
+    Domain() = default;
+    Domain(const Domain&) = delete;
+    Domain& operator=(const Domain&) = delete;
+
+    // Runs after every thread local record has been released at exit
+    ~Domain() {
+        freeExpired(orphans, ~uint64_t(0));
+        for (Record* record = records.load(std::memory_order_acquire); record != nullptr;) {
+            Record* next = record->next;
+            freeExpired(record->retired, ~uint64_t(0));
+            delete record;
+            record = next;
+        }
+    }
+
+    Record* acquire() {
+        for (Record* record = records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+            bool owned = false;
+            if (record->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+                return record;
+            }
+        }
+
+        auto* record = new Record();
+        record->next = records.load(std::memory_order_relaxed);
+        while (!records.compare_exchange_weak(record->next, record, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        }
+        return record;
+    }
+
+    // Leaves the objects the thread retired to whichever thread collects next
+    void release(Record* record) {
+        if (!record->retired.empty()) {
+            const std::lock_guard lock(orphanMutex);
+            orphans.insert(orphans.end(), record->retired.begin(), record->retired.end());
+            record->retired.clear();
+        }
+        record->state.store(0, std::memory_order_release);
+        record->owned.store(false, std::memory_order_release);
+    }
+
+    void enter(Record& record) {
+        uint64_t current = epoch.load(std::memory_order_relaxed);
+        for (;;) {
+            record.state.store((current << 1) | 1, std::memory_order_seq_cst);
+            const uint64_t now = epoch.load(std::memory_order_seq_cst);
+            if (now == current) {
+                return;
+            }
+            current = now;
+        }
+    }
+
+    void exit(Record& record) { record.state.store(0, std::memory_order_release); }
+
+    void retire(Record& record, void* pointer, void (*deleter)(void*)) {
+        record.retired.push_back({pointer, deleter, epoch.load(std::memory_order_seq_cst)});
+        if (++record.retiredSinceCollect >= CollectInterval) {
+            collect(record);
+        }
+    }
+
+    void collect(Record& record) {
+        record.retiredSinceCollect = 0;
+        tryAdvance();
+
+        const uint64_t current = epoch.load(std::memory_order_acquire);
+        freeExpired(record.retired, current);
+
+        std::unique_lock lock(orphanMutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            freeExpired(orphans, current);
+        }
+    }
+
+  private:
+    static constexpr size_t CollectInterval = 64;
+
+    void tryAdvance() {
+        uint64_t current = epoch.load(std::memory_order_seq_cst);
+        for (Record* record = records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+            const uint64_t state = record->state.load(std::memory_order_seq_cst);
+            if ((state & 1) != 0 && (state >> 1) != current) {
+                return;
+            }
+        }
+        epoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+    }
+
+    static void freeExpired(std::vector<Retired>& list, uint64_t current) {
+        const auto expired = std::stable_partition(list.begin(), list.end(), [&](const Retired& retired) {
+            return current != ~uint64_t(0) && retired.epoch + 2 > current;
+        });
+        for (auto it = expired; it != list.end(); ++it) {
+            it->deleter(it->pointer);
+        }
+        list.erase(expired, list.end());
+    }
+
+  private:
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<Record*> records{nullptr};
+    std::mutex orphanMutex;
+    std::vector<Retired> orphans;
+};
+
+inline Domain& domain() {
+    static Domain instance;
+    return instance;
+}
+
+struct ThreadRecord {
+    Record* record = domain().acquire();
+
+    ~ThreadRecord() { domain().release(record); }
+};
+
+inline Record& threadRecord() {
+    thread_local ThreadRecord local;
+    return *local.record;
+}
+
+} // namespace epoch
+} // namespace detail
+
+// Epoch based reclamation for lock-free data structures. Readers hold an EpochGuard while they dereference shared
+// nodes, and writers hand unlinked nodes to retire instead of deleting them, which frees them once every guard that
+// could still see them has ended. Guards are cheap, one store and one load, and may be nested.
+class EpochGuard {
+  public:
+    EpochGuard() : record(detail::epoch::threadRecord()) {
+        if (record.depth++ == 0) {
+            detail::epoch::domain().enter(record);
+        }
+    }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+    ~EpochGuard() {
+        if (--record.depth == 0) {
+            detail::epoch::domain().exit(record);
+        }
+    }
+
+  private:
+    detail::epoch::Record& record;
+};
+
+// Deletes the object with TDeleter once no guard entered before this call is active. The object must already be
+// unreachable for threads that start a guard later.
+template <typename T, typename TDeleter = std::default_delete<T>> void retire(T* pointer) {
+    detail::epoch::domain().retire(detail::epoch::threadRecord(), pointer,
+                                   [](void* object) { TDeleter()(static_cast<T*>(object)); });
+}
+
+// Frees what the calling thread retired as far as that is safe already, normally this happens every few retirements
+inline void collectRetired() {
+    detail::epoch::domain().collect(detail::epoch::threadRecord());
+}
+
+} // namespace memory
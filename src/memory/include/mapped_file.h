@@ -0,0 +1,136 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <stdint.h>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace memory {
+
+// Read only memory mapping of a whole file. Throws std::system_error when the file can not be opened or mapped.
+class MappedFile {
+  public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::filesystem::path& path) {
+#if defined(_WIN32)
+        const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "CreateFileW");
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            const DWORD error = GetLastError();
+            CloseHandle(file);
+            throw std::system_error(static_cast<int>(error), std::system_category(), "GetFileSizeEx");
+        }
+
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length != 0) {
+            const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            const DWORD error = GetLastError();
+            CloseHandle(file);
+            if (mapping == nullptr) {
+                throw std::system_error(static_cast<int>(error), std::system_category(), "CreateFileMappingW");
+            }
+
+            address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            const DWORD viewError = GetLastError();
+            CloseHandle(mapping);
+            if (address == nullptr) {
+                throw std::system_error(static_cast<int>(viewError), std::system_category(), "MapViewOfFile");
+            }
+        } else {
+            CloseHandle(file);
+        }
+#else
+        const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0) {
+            throw std::system_error(errno, std::generic_category(), "open");
+        }
+
+        struct stat status;
+        if (::fstat(file, &status) != 0) {
+            const int error = errno;
+            ::close(file);
+            throw std::system_error(error, std::generic_category(), "fstat");
+        }
+
+        length = static_cast<size_t>(status.st_size);
+        if (length != 0) {
+            address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+            const int error = errno;
+            ::close(file);
+            if (address == MAP_FAILED) {
+                address = nullptr;
+                throw std::system_error(error, std::generic_category(), "mmap");
+            }
+            // Most users stream through the file once
+            ::madvise(address, length, MADV_SEQUENTIAL);
+        } else {
+            ::close(file);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept
+        : address(std::exchange(other.address, nullptr)), length(std::exchange(other.length, 0)) {}
+
+    ~MappedFile() { unmap(); }
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            address = std::exchange(other.address, nullptr);
+            length = std::exchange(other.length, 0);
+        }
+        return *this;
+    }
+
+    const uint8_t* data() const { return static_cast<const uint8_t*>(address); }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    std::span<const uint8_t> bytes() const { return {data(), length}; }
+
+  private:
+    void unmap() {
+        if (address == nullptr) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(address);
+#else
+        ::munmap(address, length);
+#endif
+        address = nullptr;
+        length = 0;
+    }
+
+  private:
+    void* address = nullptr;
+    size_t length = 0;
+};
+
+} // namespace memory
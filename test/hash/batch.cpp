@@ -0,0 +1,51 @@
+#include "batch.h"
+
+#include "test_data.h"
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("Batch murmurHash3 matches single key hashing", "[batch]") {
+    const std::vector<std::string> storage = test::makeKeys(101);
+    const std::vector<std::string_view> keys(storage.begin(), storage.end());
+
+    std::vector<uint32_t> hashes(keys.size());
+    hash::murmurHash3Batch(keys, hashes, 0x9747b28c);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        REQUIRE(hashes[i] == hash::murmurHash3(keys[i], 0x9747b28c));
+    }
+}
+
+TEMPLATE_TEST_CASE("Batch fnv1a matches single key hashing", "[batch]", uint32_t, uint64_t) {
+    const std::vector<std::string> storage = test::makeKeys(101);
+    const std::vector<std::string_view> keys(storage.begin(), storage.end());
+
+    std::vector<TestType> hashes(keys.size());
+    hash::fnv1aBatch<TestType>(keys, hashes);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        REQUIRE(hashes[i] == hash::fnv1a<TestType>(keys[i]));
+    }
+}
+
+TEST_CASE("Batch hashing of fixed width keys", "[batch]") {
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < 37; ++i) {
+        keys.push_back(i * 0x9e3779b97f4a7c15ull);
+    }
+
+    std::vector<uint32_t> murmur(keys.size());
+    std::vector<uint64_t> fnv(keys.size());
+    hash::murmurHash3Batch<uint64_t>(keys, murmur);
+    hash::fnv1aBatch<uint64_t, uint64_t>(keys, fnv);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const std::string_view bytes(reinterpret_cast<const char*>(&keys[i]), sizeof(uint64_t));
+        REQUIRE(murmur[i] == hash::murmurHash3(bytes));
+        REQUIRE(fnv[i] == hash::fnv1a<uint64_t>(bytes));
+    }
+}
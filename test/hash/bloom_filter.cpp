@@ -0,0 +1,122 @@
+#include "bloom_filter.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+std::vector<std::string> makeKeys(size_t count, std::string_view prefix) {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back(std::string(prefix) + std::to_string(i));
+    }
+    return keys;
+}
+} // namespace
+
+TEST_CASE("Bloom filter has no false negatives", "[bloom_filter]") {
+    const std::vector<std::string> keys = makeKeys(20000, "key");
+
+    hash::BloomFilter filter(keys.size(), 0.01);
+    REQUIRE_FALSE(filter.contains(keys[0]));
+
+    for (const std::string& key : keys) {
+        filter.insert(key);
+    }
+    for (const std::string& key : keys) {
+        REQUIRE(filter.contains(key));
+    }
+}
+
+TEST_CASE("Bloom filter false positive rate", "[bloom_filter]") {
+    const std::vector<std::string> keys = makeKeys(20000, "key");
+    const std::vector<std::string> others = makeKeys(100000, "other");
+
+    for (const double rate : {0.1, 0.01, 0.001}) {
+        hash::BloomFilter filter(keys.size(), rate);
+        for (const std::string& key : keys) {
+            filter.insert(key);
+        }
+
+        size_t falsePositives = 0;
+        for (const std::string& key : others) {
+            falsePositives += filter.contains(key) ? 1 : 0;
+        }
+
+        REQUIRE(static_cast<double>(falsePositives) / static_cast<double>(others.size()) < rate * 1.25);
+    }
+}
+
+TEST_CASE("Bloom filter concurrent inserts", "[bloom_filter]") {
+    const std::vector<std::string> keys = makeKeys(40000, "key");
+
+    hash::BloomFilter sequential(keys.size(), 0.01);
+    for (const std::string& key : keys) {
+        sequential.insert(key);
+    }
+
+    hash::BloomFilter concurrent(keys.size(), 0.01);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = t; i < keys.size(); i += 4) {
+                concurrent.insertConcurrent(keys[i]);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(std::ranges::equal(sequential.words(), concurrent.words()));
+}
+
+TEST_CASE("Bloom filter serialization", "[bloom_filter]") {
+    const std::vector<std::string> keys = makeKeys(1000, "key");
+
+    hash::BloomFilter filter(keys.size(), 0.01, 42);
+    for (const std::string& key : keys) {
+        filter.insert(key);
+    }
+
+    const std::vector<uint64_t> blob(filter.words().begin(), filter.words().end());
+    const hash::BloomFilterView view(blob);
+    hash::BloomFilter restored(blob);
+    for (const std::string& key : keys) {
+        REQUIRE(view.contains(key));
+        REQUIRE(restored.contains(key));
+    }
+
+    restored.insert("extra");
+    REQUIRE(restored.contains("extra"));
+
+    const hash::BloomFilter copy = restored;
+    REQUIRE(std::ranges::equal(copy.words(), restored.words()));
+    REQUIRE(copy.contains("extra"));
+
+    // Lookups follow the storage through moves and assignments
+    hash::BloomFilter moved = std::move(restored);
+    REQUIRE(moved.contains("extra"));
+    REQUIRE_FALSE(restored.contains("extra"));
+    restored = copy;
+    REQUIRE(restored.contains("extra"));
+    moved = hash::BloomFilter(10, 0.01);
+    REQUIRE_FALSE(moved.contains("extra"));
+
+    REQUIRE_THROWS_AS(hash::BloomFilterView(std::span(blob).first(blob.size() - 1)), std::invalid_argument);
+    std::vector<uint64_t> corrupt = blob;
+    corrupt[0] = 0;
+    REQUIRE_THROWS_AS(hash::BloomFilterView(corrupt), std::invalid_argument);
+
+    // A block count whose size in words wraps around to the size of a one block blob
+    std::vector<uint64_t> oversized(blob.begin(), blob.begin() + 2 * hash::detail::bloom::BlockWords);
+    oversized[hash::detail::bloom::HeaderBlockCount] = (uint64_t(1) << 61) + 1;
+    REQUIRE_THROWS_AS(hash::BloomFilterView(oversized), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::BloomFilter(std::span<const uint64_t>(oversized)), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::BloomFilter(100, 0.0), std::invalid_argument);
+}
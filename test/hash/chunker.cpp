@@ -0,0 +1,123 @@
+#include "chunker.h"
+
+#include "test_data.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+std::vector<hash::Chunk> collect(std::span<const uint8_t> data, const hash::ChunkerOptions& options) {
+    std::vector<hash::Chunk> chunks;
+    hash::chunkBuffer(data, options, [&](const hash::Chunk& chunk) { chunks.push_back(chunk); });
+    return chunks;
+}
+} // namespace
+
+TEST_CASE("Chunks cover the input", "[chunker]") {
+    const std::vector<uint8_t> data = test::randomBytes(1 << 20, 1);
+    const hash::ChunkerOptions options;
+
+    const std::vector<hash::Chunk> chunks = collect(data, options);
+    REQUIRE(chunks.size() > 1);
+
+    uint64_t offset = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const hash::Chunk& chunk = chunks[i];
+        REQUIRE(chunk.offset == offset);
+        REQUIRE(chunk.data.size() <= options.maxSize);
+        if (i + 1 != chunks.size()) {
+            REQUIRE(chunk.data.data() == data.data() + offset);
+            REQUIRE(chunk.data.size() >= options.minSize);
+        }
+
+        // The span of the last chunk pointed into the chunker, which is gone by now
+        const std::span<const uint8_t> bytes = std::span(data).subspan(offset, chunk.data.size());
+        const auto [low, high] = hash::detail::murmurHash3x64(bytes.begin(), bytes.end(), 0);
+        REQUIRE(chunk.fingerprint == hash::ChunkFingerprint{low, high});
+        offset += chunk.data.size();
+    }
+    REQUIRE(offset == data.size());
+
+    // Normalized chunking keeps the mean near the requested average
+    const double mean = static_cast<double>(data.size()) / static_cast<double>(chunks.size());
+    REQUIRE(mean > options.averageSize * 0.75);
+    REQUIRE(mean < options.averageSize * 1.5);
+}
+
+TEST_CASE("Streaming gives the same chunks", "[chunker]") {
+    const std::vector<uint8_t> data = test::randomBytes(1 << 20, 2);
+    const hash::ChunkerOptions options{.minSize = 1024, .averageSize = 4096, .maxSize = 16384};
+    const std::vector<hash::Chunk> expected = collect(data, options);
+
+    std::mt19937 random(3);
+    for (const size_t maxPiece : {1, 100, 5000, 100000}) {
+        hash::ContentChunker chunker(options);
+        std::vector<std::pair<uint64_t, hash::ChunkFingerprint>> chunks;
+        const auto onChunk = [&](const hash::Chunk& chunk) { chunks.emplace_back(chunk.offset, chunk.fingerprint); };
+
+        for (size_t offset = 0; offset < data.size();) {
+            const size_t piece = std::min<size_t>(data.size() - offset, 1 + random() % maxPiece);
+            chunker.update(std::span(data).subspan(offset, piece), onChunk);
+            offset += piece;
+        }
+        chunker.finish(onChunk);
+
+        REQUIRE(chunks.size() == expected.size());
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            REQUIRE(chunks[i].first == expected[i].offset);
+            REQUIRE(chunks[i].second == expected[i].fingerprint);
+        }
+    }
+}
+
+TEST_CASE("Edits only change nearby chunks", "[chunker]") {
+    std::vector<uint8_t> data = test::randomBytes(1 << 20, 4);
+    const hash::ChunkerOptions options;
+
+    std::set<std::pair<uint64_t, uint64_t>> before;
+    for (const hash::Chunk& chunk : collect(data, options)) {
+        before.emplace(chunk.fingerprint.low, chunk.fingerprint.high);
+    }
+
+    const std::vector<uint8_t> inserted = test::randomBytes(100, 5);
+    data.insert(data.begin() + 300000, inserted.begin(), inserted.end());
+
+    const std::vector<hash::Chunk> after = collect(data, options);
+    size_t changed = 0;
+    for (const hash::Chunk& chunk : after) {
+        changed += before.contains({chunk.fingerprint.low, chunk.fingerprint.high}) ? 0 : 1;
+    }
+    REQUIRE(changed >= 1);
+    REQUIRE(changed <= 3);
+}
+
+TEST_CASE("Chunk a mapped file", "[chunker]") {
+    const std::vector<uint8_t> data = test::randomBytes(300000, 6);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "cpputils_chunker_test.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    const hash::ChunkerOptions options;
+    const std::vector<hash::Chunk> expected = collect(data, options);
+
+    std::vector<hash::ChunkFingerprint> fingerprints;
+    hash::chunkFile(path, options, [&](const hash::Chunk& chunk) { fingerprints.push_back(chunk.fingerprint); });
+    std::filesystem::remove(path);
+
+    REQUIRE(fingerprints.size() == expected.size());
+    for (size_t i = 0; i < fingerprints.size(); ++i) {
+        REQUIRE(fingerprints[i] == expected[i].fingerprint);
+    }
+
+    REQUIRE_THROWS_AS(memory::MappedFile(path), std::system_error);
+    REQUIRE_THROWS_AS(hash::ContentChunker(hash::ChunkerOptions{.minSize = 8192, .averageSize = 4096}),
+                      std::invalid_argument);
+}
@@ -0,0 +1,164 @@
+#if __has_include("tagged_ptr.h")
+
+#include "concurrent_hash_map.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+template <typename F> void runThreads(size_t count, F&& f) {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < count; ++i) {
+        threads.emplace_back(f, i);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+} // namespace
+
+TEST_CASE("Concurrent hash map operations", "[concurrent_hash_map]") {
+    hash::ConcurrentHashMap<int, int> map;
+    REQUIRE(map.empty());
+    REQUIRE(!map.find(1));
+
+    for (int i = 0; i < 10000; ++i) {
+        REQUIRE(map.tryEmplace(i, i * 3));
+    }
+    REQUIRE(!map.tryEmplace(5, 0));
+    REQUIRE(!map.insert({5, 0}));
+    REQUIRE(map.size() == 10000);
+    REQUIRE(map.bucketCount() >= 10000 / 2);
+
+    for (int i = 0; i < 10000; ++i) {
+        REQUIRE(map.find(i) == i * 3);
+    }
+    REQUIRE(!map.contains(10000));
+    REQUIRE(!map.contains(-1));
+
+    for (int i = 0; i < 10000; i += 2) {
+        REQUIRE(map.erase(i) == 1);
+    }
+    REQUIRE(map.erase(0) == 0);
+    REQUIRE(map.size() == 5000);
+
+    for (int i = 0; i < 10000; ++i) {
+        REQUIRE(map.contains(i) == (i % 2 == 1));
+    }
+
+    int visited = 0;
+    long long sum = 0;
+    map.forEach([&](int key, int value) {
+        REQUIRE(value == key * 3);
+        ++visited;
+        sum += key;
+    });
+    REQUIRE(visited == 5000);
+    REQUIRE(sum == 5000LL * 5000);
+
+    REQUIRE(map.tryEmplace(4, 7));
+    REQUIRE(map.find(4) == 7);
+}
+
+TEST_CASE("Concurrent hash map with string keys", "[concurrent_hash_map]") {
+    hash::ConcurrentHashMap<std::string, std::vector<int>> map(4);
+
+    REQUIRE(map.tryEmplace(std::string("alpha"), 3, 1));
+    REQUIRE(map.tryEmplace(std::string_view("beta"), std::vector<int>{2, 3}));
+    REQUIRE(!map.tryEmplace(std::string("beta"), 5, 5));
+
+    REQUIRE(map.find(std::string_view("alpha")) == std::vector<int>{1, 1, 1});
+    REQUIRE(map.contains("beta"));
+
+    size_t length = 0;
+    REQUIRE(map.visit(std::string_view("beta"), [&](const std::vector<int>& value) { length = value.size(); }));
+    REQUIRE(length == 2);
+    REQUIRE(!map.visit(std::string_view("gamma"), [](const std::vector<int>&) {}));
+
+    REQUIRE(map.erase(std::string_view("alpha")) == 1);
+    REQUIRE(!map.contains("alpha"));
+    REQUIRE(map.size() == 1);
+}
+
+TEST_CASE("Concurrent hash map under concurrent updates", "[concurrent_hash_map]") {
+    constexpr size_t Threads = 8;
+    constexpr int PerThread = 4000;
+
+    hash::ConcurrentHashMap<int, int> map(2);
+    std::atomic<bool> failed{false};
+
+    // Every thread inserts its own keys, checks that the keys of the other threads it sees are intact and erases every
+    // third of its keys again
+    runThreads(Threads, [&](size_t thread) {
+        const int begin = static_cast<int>(thread) * PerThread;
+        for (int key = begin; key < begin + PerThread; ++key) {
+            if (!map.tryEmplace(key, -key)) {
+                failed = true;
+            }
+            const int other = (key + PerThread) % (PerThread * static_cast<int>(Threads));
+            map.visit(other, [&](int value) {
+                if (value != -other) {
+                    failed = true;
+                }
+            });
+        }
+        for (int key = begin; key < begin + PerThread; key += 3) {
+            if (map.erase(key) != 1) {
+                failed = true;
+            }
+        }
+    });
+    REQUIRE(!failed);
+
+    size_t expected = 0;
+    for (int key = 0; key < PerThread * static_cast<int>(Threads); ++key) {
+        const bool present = (key % PerThread) % 3 != 0;
+        REQUIRE(map.contains(key) == present);
+        expected += present;
+    }
+    REQUIRE(map.size() == expected);
+    REQUIRE(map.bucketCount() >= expected / 2);
+
+    size_t visited = 0;
+    map.forEach([&](int, int) { ++visited; });
+    REQUIRE(visited == expected);
+}
+
+TEST_CASE("Concurrent hash map with contended keys", "[concurrent_hash_map]") {
+    constexpr size_t Threads = 6;
+    constexpr int Keys = 64;
+
+    hash::ConcurrentHashMap<int, int> map;
+    std::atomic<long long> balance{0};
+
+    // All threads insert and erase the same few keys, the successful calls must add up to what is left
+    runThreads(Threads, [&](size_t thread) {
+        uint32_t state = static_cast<uint32_t>(thread) + 1;
+        for (int i = 0; i < 20000; ++i) {
+            state = state * 1103515245 + 12345;
+            const int key = static_cast<int>((state >> 16) % Keys);
+            if (state & 0x8000'0000) {
+                balance += map.tryEmplace(key, key);
+            } else {
+                balance -= static_cast<long long>(map.erase(key));
+            }
+        }
+    });
+
+    long long present = 0;
+    for (int key = 0; key < Keys; ++key) {
+        if (const std::optional<int> value = map.find(key)) {
+            REQUIRE(*value == key);
+            ++present;
+        }
+    }
+    REQUIRE(present == balance);
+    REQUIRE(map.size() == static_cast<size_t>(present));
+}
+
+#endif
@@ -0,0 +1,203 @@
+#include "consistent_hash.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+std::vector<uint64_t> randomKeys(size_t count, uint32_t seed) {
+    std::mt19937_64 random(seed);
+    std::vector<uint64_t> keys(count);
+    for (uint64_t& key : keys) {
+        key = random();
+    }
+    return keys;
+}
+} // namespace
+
+TEST_CASE("Jump hash", "[consistent_hash]") {
+    const std::vector<uint64_t> keys = randomKeys(10000, 1);
+
+    for (uint32_t buckets = 1; buckets < 64; ++buckets) {
+        for (const uint64_t key : keys) {
+            const uint32_t before = hash::jumpHash(key, buckets);
+            const uint32_t after = hash::jumpHash(key, buckets + 1);
+            REQUIRE(before < buckets);
+            // Growing only moves keys into the new bucket
+            REQUIRE((after == before || after == buckets));
+        }
+    }
+
+    std::vector<size_t> counts(10);
+    for (const uint64_t key : keys) {
+        ++counts[hash::jumpHash(key, 10)];
+    }
+    for (const size_t count : counts) {
+        REQUIRE(count > 850);
+        REQUIRE(count < 1150);
+    }
+
+    static_assert(hash::jumpHash(0, 1) == 0);
+    REQUIRE(hash::jumpHash("key", 7) == hash::jumpHash(hash::detail::consistent::hashKey("key"), 7));
+    REQUIRE_THROWS_AS(hash::jumpHash(1, 0), std::invalid_argument);
+}
+
+TEST_CASE("Rendezvous scoring matches the scalar loop", "[consistent_hash]") {
+    std::mt19937 random(2);
+    for (size_t count = 1; count <= 37; ++count) {
+        std::vector<uint32_t> seeds(count);
+        std::vector<float> inverseWeights(count);
+        for (size_t i = 0; i < count; ++i) {
+            seeds[i] = static_cast<uint32_t>(random());
+            inverseWeights[i] = 1.0f / static_cast<float>(1 + random() % 4);
+        }
+
+        for (int i = 0; i < 1000; ++i) {
+            const uint32_t key = static_cast<uint32_t>(random());
+            REQUIRE(hash::detail::consistent::rendezvousBest(key, seeds.data(), inverseWeights.data(), count) ==
+                    hash::detail::consistent::rendezvousBestScalar(key, seeds.data(), inverseWeights.data(), count));
+        }
+    }
+}
+
+TEST_CASE("Rendezvous owners do not depend on the build", "[consistent_hash]") {
+    // Pinned results, which have to hold with and without AVX2 and FMA and under -ffp-contract=fast
+    hash::RendezvousHash rendezvous;
+    rendezvous.insert(1, 1.0);
+    rendezvous.insert(2, 2.0);
+    rendezvous.insert(3, 0.5);
+    rendezvous.insert(10, 3.0);
+    rendezvous.insert(11, 1.0);
+    for (uint64_t node = 20; node < 32; ++node) {
+        rendezvous.insert(node, static_cast<double>(1 + node % 3));
+    }
+
+    const std::vector<std::pair<std::string_view, uint64_t>> owners = {
+        {"alpha", 25}, {"bravo", 1},  {"charlie", 20}, {"delta", 20},    {"echo", 10},  {"foxtrot", 26},
+        {"golf", 22},  {"hotel", 29}, {"india", 10},   {"juliet", 23},   {"kilo", 11},  {"lima", 23},
+        {"mike", 29},  {"papa", 28},  {"oscar", 27},   {"november", 26},
+    };
+    for (const auto& [key, owner] : owners) {
+        REQUIRE(rendezvous.lookup(key) == owner);
+    }
+
+    static_assert(hash::detail::consistent::unitLog2(0xffffffff) == -1);
+    static_assert(hash::detail::consistent::unitLog2(0) == -24 * 16384);
+}
+
+TEST_CASE("Rendezvous hashing", "[consistent_hash]") {
+    const std::vector<uint64_t> keys = randomKeys(20000, 3);
+
+    hash::RendezvousHash forward;
+    hash::RendezvousHash backward;
+    for (uint64_t node = 0; node < 20; ++node) {
+        forward.insert(node);
+        backward.insert(19 - node);
+    }
+    REQUIRE(forward.size() == 20);
+
+    std::vector<uint64_t> owners;
+    for (const uint64_t key : keys) {
+        owners.push_back(forward.lookup(key));
+        REQUIRE(backward.lookup(key) == owners.back());
+    }
+
+    // Removing a node only moves its own keys
+    REQUIRE(forward.erase(7));
+    REQUIRE_FALSE(forward.erase(7));
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const uint64_t owner = forward.lookup(keys[i]);
+        REQUIRE(owner != 7);
+        if (owners[i] != 7) {
+            REQUIRE(owner == owners[i]);
+        }
+    }
+
+    // Weights set the share of keys
+    hash::RendezvousHash weighted;
+    weighted.insert(1, 1.0);
+    weighted.insert(2, 2.0);
+    weighted.insert(3, 1.0);
+    std::map<uint64_t, size_t> counts;
+    for (const uint64_t key : keys) {
+        ++counts[weighted.lookup(key)];
+    }
+    REQUIRE(counts[2] > 9000);
+    REQUIRE(counts[2] < 11000);
+
+    REQUIRE(weighted.lookup("key") == weighted.lookup(hash::detail::consistent::hashKey("key")));
+    REQUIRE_THROWS_AS(weighted.insert(4, 0.0), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::RendezvousHash().lookup(uint64_t(1)), std::out_of_range);
+}
+
+TEST_CASE("Hash ring", "[consistent_hash]") {
+    const std::vector<uint64_t> keys = randomKeys(20000, 4);
+
+    hash::HashRing forward;
+    hash::HashRing backward;
+    for (uint64_t node = 0; node < 10; ++node) {
+        forward.insert(node * 1000);
+        backward.insert((9 - node) * 1000);
+    }
+
+    std::vector<uint64_t> owners;
+    std::map<uint64_t, size_t> counts;
+    for (const uint64_t key : keys) {
+        owners.push_back(forward.lookup(key));
+        REQUIRE(backward.lookup(key) == owners.back());
+        ++counts[owners.back()];
+    }
+    REQUIRE(counts.size() == 10);
+    for (const auto& [node, count] : counts) {
+        REQUIRE(count > 1000);
+        REQUIRE(count < 3000);
+    }
+
+    REQUIRE(forward.erase(3000));
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (owners[i] != 3000) {
+            REQUIRE(forward.lookup(keys[i]) == owners[i]);
+        }
+    }
+
+    REQUIRE_THROWS_AS(hash::HashRing().lookup(uint64_t(1)), std::out_of_range);
+    REQUIRE_THROWS_AS(hash::HashRing(0), std::invalid_argument);
+}
+
+TEST_CASE("Hash ring with bounded loads", "[consistent_hash]") {
+    const std::vector<uint64_t> keys = randomKeys(10000, 5);
+    const double epsilon = 0.1;
+
+    hash::HashRing ring(20, epsilon);
+    for (uint64_t node = 0; node < 8; ++node) {
+        ring.insert(node);
+    }
+
+    std::vector<uint64_t> owners;
+    for (const uint64_t key : keys) {
+        owners.push_back(ring.acquire(key));
+    }
+
+    const uint64_t bound = static_cast<uint64_t>(std::ceil((1 + epsilon) * static_cast<double>(keys.size()) / 8));
+    uint64_t total = 0;
+    for (uint64_t node = 0; node < 8; ++node) {
+        REQUIRE(ring.load(node) <= bound);
+        total += ring.load(node);
+    }
+    REQUIRE(total == keys.size());
+
+    for (const uint64_t owner : owners) {
+        ring.release(owner);
+    }
+    for (uint64_t node = 0; node < 8; ++node) {
+        REQUIRE(ring.load(node) == 0);
+    }
+
+    // With spare capacity a key goes to its plain ring owner
+    REQUIRE(ring.acquire(keys[0]) == ring.lookup(keys[0]));
+}
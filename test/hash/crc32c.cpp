@@ -0,0 +1,69 @@
+#include "crc32c.h"
+
+#include "test_data.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <list>
+#include <string>
+
+namespace {
+uint32_t crc32cBytewise(std::string_view data) {
+    const std::list<char> list(data.begin(), data.end());
+    return hash::crc32c(list.begin(), list.end());
+}
+} // namespace
+
+TEST_CASE("CRC32C reference values", "[crc32c]") {
+    REQUIRE(hash::crc32c("") == 0);
+    REQUIRE(hash::crc32c("123456789") == 0xe3069283);
+    REQUIRE(hash::crc32c(std::string(32, '\0')) == 0x8a9136aa);
+    REQUIRE(hash::crc32c(std::string(32, '\xff')) == 0x62a8ab43);
+
+    std::string ascending;
+    for (int i = 0; i < 32; ++i) {
+        ascending.push_back(static_cast<char>(i));
+    }
+    REQUIRE(hash::crc32c(ascending) == 0x46dd794e);
+
+    static_assert(hash::crc32c("123456789") == 0xe3069283);
+}
+
+TEST_CASE("CRC32C accelerated paths match the bytewise table", "[crc32c]") {
+    const std::string input = test::makeInput(40000);
+
+    for (size_t length : {1, 7, 8, 9, 383, 384, 385, 1000, 6143, 6144, 6145, 12300, 40000}) {
+        const std::string_view data(input.data(), length);
+        const uint32_t expected = crc32cBytewise(data);
+
+        REQUIRE(hash::crc32c(data) == expected);
+        REQUIRE(~hash::detail::crc32cTable(~0u, hash::detail::bytePointer(data.begin()), length) == expected);
+
+#ifdef CPPUTILS_HASH_CRC32C_HARDWARE
+        const hash::detail::CpuFeatures& features = hash::detail::cpuFeatures();
+        if (features.sse42) {
+            REQUIRE(~hash::detail::crc32cHardware(~0u, hash::detail::bytePointer(data.begin()), length) == expected);
+        }
+        if (features.sse42 && features.pclmul) {
+            REQUIRE(~hash::detail::crc32cHardwareFolded(~0u, hash::detail::bytePointer(data.begin()), length) ==
+                    expected);
+        }
+#endif
+    }
+}
+
+TEST_CASE("CRC32C incremental update and combine", "[crc32c]") {
+    const std::string input = test::makeInput(20000);
+    const std::string_view data(input);
+    const uint32_t expected = hash::crc32c(data);
+
+    for (size_t split : {0, 1, 13, 384, 6144, 9999, 20000}) {
+        const std::string_view first = data.substr(0, split);
+        const std::string_view second = data.substr(split);
+
+        REQUIRE(hash::crc32c(second, hash::crc32c(first)) == expected);
+        REQUIRE(hash::crc32cCombine(hash::crc32c(first), hash::crc32c(second), second.size()) == expected);
+    }
+
+    static_assert(hash::crc32cCombine(hash::crc32c("1234"), hash::crc32c("56789"), 5) == 0xe3069283);
+}
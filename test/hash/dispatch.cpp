@@ -0,0 +1,173 @@
+#include "dispatch.h"
+
+#include "batch.h"
+#include "bloom_filter.h"
+#include "consistent_hash.h"
+#include "crc32c.h"
+#include "sketch.h"
+#include "test_data.h"
+#include "xxhash.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr hash::IsaLevel Levels[] = {hash::IsaLevel::Scalar, hash::IsaLevel::Sse42, hash::IsaLevel::Avx2,
+                                     hash::IsaLevel::Avx512};
+} // namespace
+
+TEST_CASE("Detected instruction set level", "[dispatch]") {
+    const hash::detail::CpuFeatures& features = hash::detail::cpuFeatures();
+    const hash::IsaLevel level = hash::isaLevel();
+
+    REQUIRE(level <= hash::detail::dispatch::detectIsaLevel());
+    if (level >= hash::IsaLevel::Sse42) {
+        REQUIRE(features.sse42);
+    }
+    if (level >= hash::IsaLevel::Avx2) {
+        REQUIRE(features.avx2);
+    }
+    if (level >= hash::IsaLevel::Avx512) {
+        REQUIRE(features.avx512f);
+    }
+    REQUIRE(hash::isaLevel() == level);
+
+    REQUIRE(hash::isaName(hash::IsaLevel::Scalar) == "scalar");
+    REQUIRE(hash::isaName(hash::IsaLevel::Avx512) == "avx512");
+}
+
+TEST_CASE("Select the best supported kernel", "[dispatch]") {
+    static constexpr hash::detail::Kernel<int> Kernels[] = {
+        {hash::IsaLevel::Avx512, 3},
+        {hash::IsaLevel::Avx2, 2},
+        {hash::IsaLevel::Scalar, 0},
+    };
+
+    REQUIRE(hash::detail::selectKernel(Kernels, hash::IsaLevel::Avx512) == 3);
+    REQUIRE(hash::detail::selectKernel(Kernels, hash::IsaLevel::Avx2) == 2);
+    REQUIRE(hash::detail::selectKernel(Kernels, hash::IsaLevel::Sse42) == 0);
+    REQUIRE(hash::detail::selectKernel(Kernels, hash::IsaLevel::Scalar) == 0);
+}
+
+TEST_CASE("Every kernel level gives the same hashes", "[dispatch]") {
+    const std::vector<std::string> storage = test::makeKeys(203, 20);
+    const std::vector<std::string_view> keys(storage.begin(), storage.end());
+    const hash::IsaLevel detected = hash::detail::dispatch::detectIsaLevel();
+
+    std::vector<uint32_t> expectedMurmur;
+    std::vector<uint32_t> expectedFnv;
+    for (const std::string_view key : keys) {
+        expectedMurmur.push_back(hash::murmurHash3(key, 42));
+        expectedFnv.push_back(hash::fnv1a<uint32_t>(key));
+    }
+
+    std::string data;
+    for (const std::string& key : storage) {
+        data += key;
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    const uint32_t expectedCrc = hash::detail::crc32cTable(0, bytes, data.size());
+
+    for (const hash::IsaLevel level : Levels) {
+        if (level > detected) {
+            continue;
+        }
+
+        const hash::detail::batch::GroupKernels kernels = hash::detail::batch::selectGroupKernels(level);
+        if (level >= hash::IsaLevel::Avx2) {
+            REQUIRE(kernels.lanes > 1);
+        }
+
+        std::vector<uint32_t> murmur(keys.size());
+        std::vector<uint32_t> fnv(keys.size());
+        hash::detail::batch::murmurHash3Batch<std::string_view>(keys, murmur, 42, kernels);
+        hash::detail::batch::fnv1aBatch<uint32_t, std::string_view>(keys, fnv, kernels);
+        REQUIRE(murmur == expectedMurmur);
+        REQUIRE(fnv == expectedFnv);
+
+        REQUIRE(hash::detail::selectCrc32c(level)(0, bytes, data.size()) == expectedCrc);
+    }
+}
+
+TEST_CASE("Every kernel level matches the scalar kernels", "[dispatch]") {
+    using Constants = hash::detail::Xxh3Constants;
+    const hash::IsaLevel detected = hash::detail::dispatch::detectIsaLevel();
+    const std::vector<uint8_t> bytes = test::randomBytes(Constants::StripeLength * 16 + 200, 7);
+
+    // Secrets at every offset the accumulation starts from, including unaligned ones
+    uint64_t expectedAcc[Constants::Accumulators] = {1, 2, 3, 4, 5, 6, 7, 8};
+    for (size_t offset = 0; offset < 3; ++offset) {
+        hash::detail::xxh3AccumulateScalar(expectedAcc, bytes.data() + offset, hash::detail::Xxh3Secret + offset, 16);
+        hash::detail::xxh3ScrambleScalar(expectedAcc, hash::detail::Xxh3Secret + offset);
+    }
+
+    // Blocks that miss one bit of the mask and blocks that hold all of it
+    std::vector<hash::detail::bloom::BlockMask> masks;
+    std::vector<hash::detail::bloom::BlockMask> blocks;
+    for (size_t i = 0; i < 64; ++i) {
+        hash::detail::bloom::BlockMask mask{};
+        hash::detail::bloom::BlockMask block{};
+        std::memcpy(mask.data(), bytes.data() + i * 8, sizeof(mask));
+        std::memcpy(block.data(), bytes.data() + i * 8 + 64, sizeof(block));
+        if (i % 2 == 0) {
+            for (size_t word = 0; word < mask.size(); ++word) {
+                block[word] |= mask[word];
+            }
+        }
+        masks.push_back(mask);
+        blocks.push_back(block);
+    }
+
+    std::vector<uint8_t> expectedRegisters(bytes.begin(), bytes.begin() + 999);
+    hash::detail::sketch::maxRegistersScalar(expectedRegisters.data(), bytes.data() + 201, expectedRegisters.size());
+
+    std::vector<uint32_t> seeds;
+    std::vector<float> inverseWeights;
+    for (size_t i = 0; i < 21; ++i) {
+        seeds.push_back(hash::detail::fmix<uint32_t>(static_cast<uint32_t>(i)));
+        inverseWeights.push_back(1.0f / static_cast<float>(1 + i % 4));
+    }
+
+    for (const hash::IsaLevel level : Levels) {
+        if (level > detected) {
+            continue;
+        }
+
+        const hash::detail::Xxh3Kernels xxh3 = hash::detail::selectXxh3Kernels(level);
+        uint64_t acc[Constants::Accumulators] = {1, 2, 3, 4, 5, 6, 7, 8};
+        for (size_t offset = 0; offset < 3; ++offset) {
+            xxh3.accumulate(acc, bytes.data() + offset, hash::detail::Xxh3Secret + offset, 16);
+            xxh3.scramble(acc, hash::detail::Xxh3Secret + offset);
+        }
+        REQUIRE(std::equal(acc, acc + Constants::Accumulators, expectedAcc));
+
+        const hash::detail::bloom::BlockKernels bloom = hash::detail::bloom::selectBlockKernels(level);
+        for (size_t i = 0; i < masks.size(); ++i) {
+            REQUIRE(bloom.test(blocks[i].data(), masks[i]) ==
+                    hash::detail::bloom::testBlockScalar(blocks[i].data(), masks[i]));
+
+            hash::detail::bloom::BlockMask block = blocks[i];
+            hash::detail::bloom::BlockMask expectedBlock = blocks[i];
+            bloom.set(block.data(), masks[i]);
+            hash::detail::bloom::setBlockScalar(expectedBlock.data(), masks[i]);
+            REQUIRE(block == expectedBlock);
+        }
+
+        // Register counts that leave a tail after every vector width
+        std::vector<uint8_t> registers(bytes.begin(), bytes.begin() + 999);
+        hash::detail::sketch::selectMaxRegisters(level)(registers.data(), bytes.data() + 201, registers.size());
+        REQUIRE(registers == expectedRegisters);
+
+        const hash::detail::consistent::RendezvousBestFunction best =
+            hash::detail::consistent::selectRendezvousBest(level);
+        for (uint32_t key = 0; key < 500; ++key) {
+            const size_t count = 1 + key % seeds.size();
+            REQUIRE(best(key, seeds.data(), inverseWeights.data(), count) ==
+                    hash::detail::consistent::rendezvousBestScalar(key, seeds.data(), inverseWeights.data(), count));
+        }
+    }
+}
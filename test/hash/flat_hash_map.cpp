@@ -0,0 +1,133 @@
+#include "flat_hash_map.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+
+TEST_CASE("Insert and find", "[flat_hash_map]") {
+    hash::FlatHashMap<int, int> map;
+    REQUIRE(map.empty());
+    REQUIRE(map.find(1) == map.end());
+    REQUIRE(map.begin() == map.end());
+
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(map.tryEmplace(i, i * 2).second);
+    }
+    REQUIRE(map.size() == 1000);
+    REQUIRE_FALSE(map.tryEmplace(5, 0).second);
+
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(map.contains(i));
+        REQUIRE(map.at(i) == i * 2);
+    }
+    REQUIRE_FALSE(map.contains(1000));
+    REQUIRE_THROWS_AS(map.at(1000), std::out_of_range);
+
+    map[2000] = 7;
+    REQUIRE(map[2000] == 7);
+    REQUIRE(map.size() == 1001);
+
+    size_t visited = 0;
+    for (const auto& [key, value] : map) {
+        REQUIRE(map.at(key) == value);
+        ++visited;
+    }
+    REQUIRE(visited == map.size());
+}
+
+TEST_CASE("Heterogeneous string lookup", "[flat_hash_map]") {
+    hash::FlatHashMap<std::string, int> map = {{"alpha", 1}, {"beta", 2}};
+
+    REQUIRE(map.find(std::string_view("alpha"))->second == 1);
+    REQUIRE(map.contains("beta"));
+    REQUIRE_FALSE(map.contains(std::string_view("gamma")));
+
+    map[std::string_view("gamma")] = 3;
+    REQUIRE(map.at(std::string("gamma")) == 3);
+    REQUIRE(map.erase(std::string_view("alpha")) == 1);
+    REQUIRE(map.erase("alpha") == 0);
+    REQUIRE(map.size() == 2);
+}
+
+TEST_CASE("Erase and reuse against std::map", "[flat_hash_map]") {
+    hash::FlatHashMap<uint64_t, std::unique_ptr<uint64_t>> map;
+    std::map<uint64_t, uint64_t> reference;
+
+    std::mt19937_64 random(42);
+    for (size_t i = 0; i < 200000; ++i) {
+        const uint64_t key = random() % 5000;
+        if (random() % 3 == 0) {
+            REQUIRE(map.erase(key) == reference.erase(key));
+        } else {
+            const bool inserted = map.tryEmplace(key, std::make_unique<uint64_t>(key)).second;
+            REQUIRE(inserted == reference.emplace(key, key).second);
+        }
+    }
+
+    REQUIRE(map.size() == reference.size());
+    for (const auto& [key, value] : reference) {
+        REQUIRE(*map.at(key) == value);
+    }
+    for (const auto& [key, value] : map) {
+        REQUIRE(reference.count(key) == 1);
+    }
+}
+
+TEST_CASE("Copy, move, reserve and clear", "[flat_hash_map]") {
+    hash::FlatHashMap<std::string, std::string> map;
+    map.reserve(100);
+    const size_t capacity = map.capacity();
+    for (int i = 0; i < 100; ++i) {
+        map[std::to_string(i)] = std::string(40, static_cast<char>('a' + i % 26));
+    }
+    REQUIRE(map.capacity() == capacity);
+
+    hash::FlatHashMap<std::string, std::string> copy = map;
+    REQUIRE(copy.size() == 100);
+    REQUIRE(copy.at("42") == map.at("42"));
+
+    hash::FlatHashMap<std::string, std::string> moved = std::move(copy);
+    REQUIRE(moved.size() == 100);
+    REQUIRE(copy.empty());
+    REQUIRE_FALSE(copy.contains("42"));
+
+    moved.erase(moved.find("42"));
+    REQUIRE(moved.size() == 99);
+    REQUIRE(map.contains("42"));
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.begin() == map.end());
+    map["x"] = "y";
+    REQUIRE(map.at("x") == "y");
+}
+
+#if defined(CPPUTILS_UINT128)
+TEST_CASE("128 bit keys that differ only in the high half", "[flat_hash_map]") {
+    const hash::DefaultHasher hasher;
+    REQUIRE(hasher(uint128_t(1) << 64) != hasher(uint128_t(2) << 64));
+
+    hash::FlatHashMap<uint128_t, int> map;
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(map.tryEmplace(static_cast<uint128_t>(i) << 64, i).second);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(map.at(static_cast<uint128_t>(i) << 64) == i);
+    }
+    REQUIRE_FALSE(map.contains(1));
+
+    // The low bits pick the group, a hasher that drops the high half puts every key in one probe chain
+    std::set<size_t> lowBits;
+    for (int i = 0; i < 1000; ++i) {
+        lowBits.insert(hasher(static_cast<uint128_t>(i) << 64) & 0xffff);
+    }
+    REQUIRE(lowBits.size() > 900);
+#if defined(CPPUTILS_INT128)
+    REQUIRE(hasher(int128_t(1) << 64) != hasher(int128_t(-1) << 64));
+#endif
+}
+#endif
@@ -0,0 +1,44 @@
+
+#include "fnv1a.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <list>
+#include <string>
+
+TEST_CASE("FNV-1a reference values", "[fnv1a]") {
+    REQUIRE(hash::fnv1a<uint32_t>("") == 0x811c9dc5);
+    REQUIRE(hash::fnv1a<uint32_t>("a") == 0xe40c292c);
+    REQUIRE(hash::fnv1a<uint32_t>("foobar") == 0xbf9cf968);
+    REQUIRE(hash::fnv1a<uint64_t>("") == 0xcbf29ce484222325);
+    REQUIRE(hash::fnv1a<uint64_t>("a") == 0xaf63dc4c8601ec8c);
+    REQUIRE(hash::fnv1a<uint64_t>("foobar") == 0x85944171f73967e8);
+
+    static_assert(hash::fnv1a<uint32_t>("foobar") == 0xbf9cf968);
+    static_assert(hash::fnv1a<uint64_t>("foobar") == 0x85944171f73967e8);
+}
+
+TEST_CASE("FNV-1a contiguous and non-contiguous input agree", "[fnv1a]") {
+    std::string input;
+    for (size_t i = 0; i < 41; ++i) {
+        input.push_back(static_cast<char>(i * 71 + 3));
+    }
+
+    for (size_t length = 0; length <= input.size(); ++length) {
+        const std::string_view data(input.data(), length);
+        const std::list<char> list(data.begin(), data.end());
+
+        REQUIRE(hash::fnv1a<uint32_t>(data) == hash::fnv1a<uint32_t>(list.begin(), list.end()));
+        REQUIRE(hash::fnv1a<uint64_t>(data) == hash::fnv1a<uint64_t>(list.begin(), list.end()));
+    }
+}
+
+TEST_CASE("FNV-1a seed", "[fnv1a]") {
+    REQUIRE(hash::fnv1a<uint64_t>("foobar", 0) == hash::fnv1a<uint64_t>("foobar"));
+    REQUIRE(hash::fnv1a<uint64_t>("foobar", 1) != hash::fnv1a<uint64_t>("foobar"));
+    REQUIRE(hash::fnv1a<uint32_t>("foobar", 1) != hash::fnv1a<uint32_t>("foobar", 2));
+
+    const std::string_view data = "some longer input crossing a word boundary";
+    const std::list<char> list(data.begin(), data.end());
+    REQUIRE(hash::fnv1a<uint64_t>(data, 42) == hash::fnv1a<uint64_t>(list.begin(), list.end(), uint64_t(42)));
+}
@@ -0,0 +1,120 @@
+#include "hasher.h"
+
+#include "flat_hash_map.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <bit>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#if __has_include("inline_string.h")
+#include "inline_string.h"
+#endif
+
+namespace {
+struct Point {
+    int32_t x;
+    int32_t y;
+};
+
+struct Empty {};
+
+struct Named {
+    int id;
+    std::string name;
+};
+} // namespace
+
+template <> struct hash::Hasher<Named> {
+    void operator()(hash::HashState& state, const Named& value) const { state.update(value.id).update(value.name); }
+};
+
+TEST_CASE("Combine scalars", "[hasher]") {
+    static_assert(hash::combine(1, 2) == hash::combine(1, 2));
+    static_assert(hash::combine(1, 2) != hash::combine(2, 1));
+
+    REQUIRE(hash::combine(0.0) == hash::combine(-0.0));
+    REQUIRE(hash::combine(1.0f) != hash::combine(1.0));
+    REQUIRE(hash::combine(uint8_t(7)) == hash::combine(uint64_t(7)));
+    REQUIRE(hash::combine(1, 2) != hash::combine(1, 2, 0));
+
+#if defined(CPPUTILS_UINT128)
+    const uint128_t wide = (static_cast<uint128_t>(3) << 64) | 5;
+    REQUIRE(hash::combine(wide) == hash::combine(uint64_t(5), uint64_t(3)));
+    REQUIRE(hash::combine(wide) != hash::combine(static_cast<uint128_t>(5)));
+#endif
+#if defined(CPPUTILS_INT128)
+    REQUIRE(hash::combine(static_cast<int128_t>(-1)) == hash::combine(~uint64_t(0), ~uint64_t(0)));
+#endif
+}
+
+TEST_CASE("Combine strings and aggregates", "[hasher]") {
+    const std::string text = "group by key";
+    REQUIRE(hash::combine(text) == hash::combine(std::string_view(text)));
+    REQUIRE(hash::combine(text) == hash::combine("group by key"));
+    // The length is part of the hash, so moving bytes between strings changes it
+    REQUIRE(hash::combine(std::string("ab"), std::string("c")) != hash::combine(std::string("a"), std::string("bc")));
+
+    REQUIRE(hash::combine(std::pair(1, text)) == hash::combine(1, text));
+    REQUIRE(hash::combine(std::tuple(1, 2.5, text)) == hash::combine(1, 2.5, text));
+    REQUIRE(hash::combine(std::tuple(1, std::pair(2, text))) == hash::combine(1, 2, text));
+    REQUIRE(hash::combine(std::array<std::string, 2>{"a", "b"}) == hash::combine("a", "b"));
+
+    // Tuple like types hash element by element even when their bytes could be hashed in one go
+    REQUIRE(hash::combine(std::array<int, 2>{1, 2}) == hash::combine(std::pair(1, 2)));
+    REQUIRE(hash::combine(std::array<int, 2>{1, 2}) == hash::combine(std::tuple(1, 2)));
+    REQUIRE(hash::combine(std::array<int, 2>{1, 2}) == hash::combine(1, 2));
+    REQUIRE(hash::combine(std::array<uint8_t, 3>{1, 2, 3}) == hash::combine(uint8_t(1), uint8_t(2), uint8_t(3)));
+
+    // Padding free structs hash their bytes
+    REQUIRE(hash::combine(Point{1, 2}) == hash::combine(std::bit_cast<uint64_t>(Point{1, 2})));
+    REQUIRE(hash::combine(Point{1, 2}) != hash::combine(Point{2, 1}));
+
+    REQUIRE(hash::combine(Named{1, "a"}) == hash::combine(1, "a"));
+
+#if __has_include("compressed_pair.h")
+    REQUIRE(hash::combine(memory::CompressedPair<int, std::string>(1, text)) == hash::combine(1, text));
+    REQUIRE(hash::combine(memory::CompressedPair<Empty, int>(Empty{}, 4)) == hash::combine(4));
+#endif
+
+#if __has_include("inline_string.h")
+    REQUIRE(hash::combine(str::InlineString<16>("group by key")) == hash::combine(text));
+#endif
+}
+
+TEST_CASE("Combine distributes composite keys", "[hasher]") {
+    // Small dense keys are the worst case for chained std::hash, which is the identity on integers in libstdc++
+    std::set<uint64_t> hashes;
+    std::array<size_t, 64> buckets{};
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            for (int c = 0; c < 16; ++c) {
+                const uint64_t hash = hash::combine(a, b, c);
+                hashes.insert(hash);
+                ++buckets[hash & 63];
+            }
+        }
+    }
+    REQUIRE(hashes.size() == 64 * 64 * 16);
+    for (const size_t count : buckets) {
+        REQUIRE(count > 800);
+        REQUIRE(count < 1250);
+    }
+
+    hash::FlatHashMap<std::tuple<int, std::string>, int> map;
+    map[{1, "a"}] = 1;
+    map[{1, "b"}] = 2;
+    REQUIRE(map.size() == 2);
+    REQUIRE(map.at(std::tuple<int, std::string>(1, "b")) == 2);
+
+    hash::FlatHashMap<Point, int, hash::CompositeHasher, decltype([](const Point& lhs, const Point& rhs) {
+                          return lhs.x == rhs.x && lhs.y == rhs.y;
+                      })>
+        points;
+    points[Point{1, 2}] = 3;
+    REQUIRE(points.at(Point{1, 2}) == 3);
+}
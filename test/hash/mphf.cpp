@@ -0,0 +1,92 @@
+#include "mphf.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<std::string> makeKeys(size_t count) {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back("key-" + std::to_string(i * 2654435761u));
+    }
+    return keys;
+}
+
+template <typename TFunction> bool isMinimalPerfect(const TFunction& function, const std::vector<std::string>& keys) {
+    std::vector<bool> used(keys.size());
+    for (const std::string& key : keys) {
+        const size_t position = function(key);
+        if (position >= keys.size() || used[position]) {
+            return false;
+        }
+        used[position] = true;
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE("Maps keys onto a permutation", "[mphf]") {
+    const std::vector<std::string> keys = makeKeys(200000);
+    const hash::MinimalPerfectHash function = hash::buildMinimalPerfectHash(keys, {.threads = 4});
+
+    REQUIRE(function.size() == keys.size());
+    REQUIRE(isMinimalPerfect(function, keys));
+
+    const double bitsPerKey = static_cast<double>(function.words().size() * 64) / static_cast<double>(keys.size());
+    REQUIRE(bitsPerKey < 4.0);
+}
+
+TEST_CASE("Result does not depend on the thread count", "[mphf]") {
+    const std::vector<std::string> keys = makeKeys(50000);
+    const hash::MinimalPerfectHash single = hash::buildMinimalPerfectHash(keys, {.threads = 1, .seed = 7});
+    const hash::MinimalPerfectHash parallel = hash::buildMinimalPerfectHash(keys, {.threads = 3, .seed = 7});
+
+    REQUIRE(std::ranges::equal(single.words(), parallel.words()));
+}
+
+TEST_CASE("Serialized form round trips", "[mphf]") {
+    const std::vector<std::string> keys = makeKeys(10000);
+    const hash::MinimalPerfectHash function = hash::buildMinimalPerfectHash(keys, {.gamma = 2.0});
+
+    const std::vector<uint64_t> blob(function.words().begin(), function.words().end());
+    const hash::MinimalPerfectHashView view(blob);
+    REQUIRE(view.size() == keys.size());
+    for (const std::string& key : keys) {
+        REQUIRE(view(key) == function(key));
+    }
+
+    const hash::MinimalPerfectHash copy{std::vector<uint64_t>(blob)};
+    REQUIRE(isMinimalPerfect(copy, keys));
+
+    REQUIRE_THROWS_AS(hash::MinimalPerfectHashView(std::span(blob).first(blob.size() - 1)), std::invalid_argument);
+
+    // Level ranges and counts that point past the bit array are rejected up front
+    using namespace hash::detail::mphf;
+    const auto corrupted = [&](size_t index, uint64_t value) {
+        std::vector<uint64_t> corrupt = blob;
+        corrupt[index] = value;
+        return corrupt;
+    };
+    const uint64_t totalBits = blob[HeaderBitWords] * 64;
+    REQUIRE(blob[HeaderLevelCount] > 1);
+    REQUIRE_THROWS_AS(hash::MinimalPerfectHashView(corrupted(HeaderSize + 1, totalBits + 64)), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::MinimalPerfectHashView(corrupted(HeaderSize + 1, 0)), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::MinimalPerfectHashView(corrupted(HeaderSize + 2, totalBits)), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::MinimalPerfectHashView(corrupted(HeaderSize + 2, ~uint64_t(0))), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::MinimalPerfectHashView(corrupted(HeaderBitWords, uint64_t(1) << 62)),
+                      std::invalid_argument);
+}
+
+TEST_CASE("Edge cases", "[mphf]") {
+    const std::vector<std::string> none;
+    REQUIRE(hash::buildMinimalPerfectHash(none).size() == 0);
+
+    const std::vector<std::string> one = {"only"};
+    REQUIRE(hash::buildMinimalPerfectHash(one)("only") == 0);
+
+    const std::vector<std::string_view> duplicates = {"a", "b", "a"};
+    REQUIRE_THROWS_AS(hash::buildMinimalPerfectHash(duplicates), std::invalid_argument);
+}
@@ -0,0 +1,96 @@
+
+#include "murmur.h"
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <list>
+#include <string>
+
+namespace {
+constexpr std::string_view quickBrownFox("The quick brown fox jumps over the lazy dog");
+}
+
+TEST_CASE("Reference values", "[murmur]") {
+    REQUIRE(hash::murmurHash3("") == 0);
+    REQUIRE(hash::murmurHash3("", 1) == 0x514e28b7);
+    REQUIRE(hash::murmurHash3("a") == 0x3c2569b2);
+    REQUIRE(hash::murmurHash3("abc") == 0xb3dd93fa);
+    REQUIRE(hash::murmurHash3("hello") == 0x248bfa47);
+    REQUIRE(hash::murmurHash3("hello, world") == 0x149bbb7f);
+    REQUIRE(hash::murmurHash3(quickBrownFox) == 0x2e4ff723);
+    REQUIRE(hash::murmurHash3(quickBrownFox, 0x9747b28c) == 0x2fa826cd);
+}
+
+TEST_CASE("Constant evaluation", "[murmur]") {
+    static_assert(hash::murmurHash3("hello") == 0x248bfa47);
+    static_assert(hash::MurmurHasher<uint32_t>().update("hel").update("lo").finalize() == 0x248bfa47);
+}
+
+TEMPLATE_TEST_CASE("Incremental", "[murmur]", uint32_t, uint64_t) {
+    std::string input;
+    for (size_t i = 0; i < 64; ++i) {
+        input.push_back(static_cast<char>(i * 37 + 11));
+    }
+
+    for (size_t length = 0; length <= input.size(); ++length) {
+        const std::string_view data(input.data(), length);
+        const TestType expected = hash::murmurHash3<TestType>(data.begin(), data.end(), 42);
+
+        for (size_t split = 0; split <= length; ++split) {
+            hash::MurmurHasher<TestType> hasher(42);
+            hasher.update(data.substr(0, split));
+            hasher.update(data.substr(split));
+            REQUIRE(hasher.finalize() == expected);
+        }
+
+        hash::MurmurHasher<TestType> bytewise(42);
+        for (const char character : data) {
+            bytewise.update(std::span<const char>(&character, 1));
+        }
+        REQUIRE(bytewise.finalize() == expected);
+    }
+}
+
+TEST_CASE("Reset", "[murmur]") {
+    hash::MurmurHasher<uint32_t> hasher;
+    hasher.update("garbage");
+    hasher.reset(0x9747b28c);
+    hasher.update(quickBrownFox);
+    REQUIRE(hasher.finalize() == 0x2fa826cd);
+}
+
+#ifdef CPPUTILS_UINT128
+TEST_CASE("128 bit reference values", "[murmur]") {
+    const auto make = [](uint64_t high, uint64_t low) { return (static_cast<uint128_t>(high) << 64) | low; };
+
+    REQUIRE(hash::murmurHash3_128("") == 0);
+    REQUIRE(hash::murmurHash3_128("", 1) == make(0x51622daa78f83583, 0x4610abe56eff5cb5));
+    REQUIRE(hash::murmurHash3_128("a") == make(0xe6b53a48510e895a, 0x85555565f6597889));
+    REQUIRE(hash::murmurHash3_128("abc") == make(0x3ba2744126ca2d52, 0xb4963f3f3fad7867));
+    REQUIRE(hash::murmurHash3_128("hello") == make(0x5b1e906a48ae1d19, 0xcbd8a7b341bd9b02));
+    REQUIRE(hash::murmurHash3_128("hello, world") == make(0x4cdcbc079642414d, 0x342fac623a5ebc8e));
+    REQUIRE(hash::murmurHash3_128(quickBrownFox) == make(0x7a433ca9c49a9347, 0xe34bbc7bbc071b6c));
+    REQUIRE(hash::murmurHash3_128(quickBrownFox, 0x9747b28c) == make(0xf94573727ec016e5, 0x738a7f3bd2633121));
+}
+#endif
+
+TEST_CASE("Contiguous and non-contiguous input agree", "[murmur]") {
+    std::string input;
+    for (size_t i = 0; i < 53; ++i) {
+        input.push_back(static_cast<char>(i * 13 + 7));
+    }
+
+    for (size_t length = 0; length <= input.size(); ++length) {
+        const std::string_view data(input.data(), length);
+        const std::list<char> list(data.begin(), data.end());
+
+        REQUIRE(hash::murmurHash3<uint32_t>(data.begin(), data.end(), 7) ==
+                hash::murmurHash3<uint32_t>(list.begin(), list.end(), 7));
+        REQUIRE(hash::murmurHash3<uint64_t>(data.begin(), data.end(), 7) ==
+                hash::murmurHash3<uint64_t>(list.begin(), list.end(), 7));
+#ifdef CPPUTILS_UINT128
+        REQUIRE(hash::murmurHash3_128(data, 7) == hash::murmurHash3_128(list.begin(), list.end(), 7));
+#endif
+    }
+}
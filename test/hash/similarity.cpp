@@ -0,0 +1,119 @@
+#include "similarity.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// Two feature sets over disjoint ranges of integers that share `shared` of `total` features
+std::pair<std::vector<std::string>, std::vector<std::string>> overlappingSets(size_t total, size_t shared, int base) {
+    std::vector<std::string> lhs;
+    std::vector<std::string> rhs;
+    for (size_t i = 0; i < total; ++i) {
+        lhs.push_back(std::to_string(base + static_cast<int>(i)));
+        rhs.push_back(std::to_string(base + static_cast<int>(i < shared ? i : i + total)));
+    }
+    return {lhs, rhs};
+}
+
+std::vector<uint64_t> signature(const std::vector<std::string>& features, size_t bins) {
+    hash::MinHash minHash(bins, 7);
+    for (const std::string& feature : features) {
+        minHash.insert(feature);
+    }
+    return minHash.signature();
+}
+} // namespace
+
+TEST_CASE("MinHash estimates Jaccard similarity", "[similarity]") {
+    for (const size_t total : {20, 1000}) {
+        for (const size_t shared : {total / 4, total / 2, total * 9 / 10}) {
+            const auto [lhs, rhs] = overlappingSets(total, shared, 100000);
+            const double jaccard = static_cast<double>(shared) / static_cast<double>(2 * total - shared);
+            const double estimate = hash::jaccardEstimate(signature(lhs, 1024), signature(rhs, 1024));
+            REQUIRE(std::abs(estimate - jaccard) < 0.06);
+        }
+    }
+
+    // Insertion order and duplicates do not matter
+    const auto [lhs, rhs] = overlappingSets(100, 50, 0);
+    std::vector<std::string> shuffled = lhs;
+    shuffled.insert(shuffled.end(), lhs.begin(), lhs.end());
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+    REQUIRE(signature(shuffled, 128) == signature(lhs, 128));
+
+    const std::vector<uint64_t> empty = hash::MinHash(16).signature();
+    REQUIRE(std::count(empty.begin(), empty.end(), std::numeric_limits<uint64_t>::max()) == 16);
+
+    REQUIRE_THROWS_AS(hash::MinHash(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::jaccardEstimate(signature(lhs, 8), signature(lhs, 16)), std::invalid_argument);
+}
+
+TEST_CASE("SimHash", "[similarity]") {
+    const auto fingerprint = [](const std::vector<std::string>& features) {
+        hash::SimHash simHash;
+        for (const std::string& feature : features) {
+            simHash.insert(feature);
+        }
+        return simHash.value();
+    };
+
+    const auto [base, near] = overlappingSets(400, 380, 0);
+    const auto [other, unused] = overlappingSets(400, 0, 1000000);
+    REQUIRE(hash::hammingDistance(fingerprint(base), fingerprint(base)) == 0);
+    REQUIRE(hash::hammingDistance(fingerprint(base), fingerprint(near)) < 12);
+    REQUIRE(hash::hammingDistance(fingerprint(base), fingerprint(other)) > 16);
+
+    // A heavy feature dominates the fingerprint
+    hash::SimHash weighted;
+    weighted.insert("a", 1);
+    weighted.insert("b", 10);
+    hash::SimHash single;
+    single.insert("b");
+    REQUIRE(weighted.value() == single.value());
+
+    weighted.clear();
+    REQUIRE(weighted.value() == 0);
+}
+
+TEST_CASE("LSH index finds similar signatures", "[similarity]") {
+    constexpr size_t Bands = 16;
+    constexpr size_t Rows = 4;
+    hash::LshIndex index(Bands, Rows);
+    REQUIRE(index.threshold() > 0.4);
+    REQUIRE(index.threshold() < 0.6);
+
+    std::vector<std::vector<uint64_t>> near;
+    for (int document = 0; document < 200; ++document) {
+        const auto [lhs, rhs] = overlappingSets(200, 190, document * 1000);
+        const std::vector<uint64_t> stored = signature(lhs, Bands * Rows);
+        index.insert(static_cast<uint64_t>(document), stored);
+        near.push_back(signature(rhs, Bands * Rows));
+    }
+    REQUIRE(index.size() == 200);
+
+    for (uint64_t document = 0; document < near.size(); ++document) {
+        const std::vector<uint64_t> candidates = index.candidates(near[document]);
+        REQUIRE(std::find(candidates.begin(), candidates.end(), document) != candidates.end());
+        // Unrelated documents only show up by chance
+        REQUIRE(candidates.size() < 3);
+    }
+
+    const auto [lhs, rhs] = overlappingSets(200, 0, 5000000);
+    REQUIRE(index.candidates(signature(lhs, Bands * Rows)).empty());
+
+    size_t reported = 0;
+    index.forEachCandidate(signature(overlappingSets(200, 190, 0).first, Bands * Rows), [&](uint64_t id) {
+        REQUIRE(id == 0);
+        ++reported;
+    });
+    REQUIRE(reported == Bands);
+
+    REQUIRE_THROWS_AS(index.insert(1, std::vector<uint64_t>(3)), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::LshIndex(0, 4), std::invalid_argument);
+}
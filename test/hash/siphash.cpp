@@ -0,0 +1,91 @@
+#include "siphash.h"
+
+#include "flat_hash_map.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <list>
+#include <string>
+
+namespace {
+std::string sequence(size_t length) {
+    std::string result;
+    for (size_t i = 0; i < length; ++i) {
+        result.push_back(static_cast<char>(i));
+    }
+    return result;
+}
+} // namespace
+
+TEST_CASE("SipHash-2-4 reference values", "[siphash]") {
+    const hash::SipKey key{0x0706050403020100ull, 0x0f0e0d0c0b0a0908ull};
+
+    REQUIRE(hash::sipHash24(sequence(0), key) == 0x726fdb47dd0e0e31ull);
+    REQUIRE(hash::sipHash24(sequence(1), key) == 0x74f839c593dc67fdull);
+    REQUIRE(hash::sipHash24(sequence(7), key) == 0xab0200f58b01d137ull);
+    REQUIRE(hash::sipHash24(sequence(8), key) == 0x93f5f5799a932462ull);
+    REQUIRE(hash::sipHash24(sequence(15), key) == 0xa129ca6149be45e5ull);
+    REQUIRE(hash::sipHash24(sequence(16), key) == 0x3f2acc7f57c29bdbull);
+    REQUIRE(hash::sipHash24(sequence(63), key) == 0x958a324ceb064572ull);
+
+    static_assert(hash::sipHash24("", hash::SipKey{0x0706050403020100ull, 0x0f0e0d0c0b0a0908ull}) ==
+                  0x726fdb47dd0e0e31ull);
+}
+
+TEST_CASE("SipHash-1-3 reference values", "[siphash]") {
+    const hash::SipKey key{};
+
+    REQUIRE(hash::sipHash13(sequence(0), key) == 0xd1fba762150c532cull);
+    REQUIRE(hash::sipHash13(sequence(1), key) == 0x68a914128e01e473ull);
+    REQUIRE(hash::sipHash13(sequence(7), key) == 0x2f098ab0c751325aull);
+    REQUIRE(hash::sipHash13(sequence(8), key) == 0xead411e67ebe2eeaull);
+    REQUIRE(hash::sipHash13(sequence(15), key) == 0xf30eb725bb91c9eaull);
+    REQUIRE(hash::sipHash13(sequence(16), key) == 0x8972188433a5c5b7ull);
+    REQUIRE(hash::sipHash13(sequence(63), key) == 0x385d3e39e5f37359ull);
+}
+
+TEST_CASE("SipHash contiguous and non-contiguous input agree", "[siphash]") {
+    const hash::SipKey key{0x0123456789abcdefull, 0xfedcba9876543210ull};
+    const std::string input = sequence(41);
+
+    for (size_t length = 0; length <= input.size(); ++length) {
+        const std::string_view data(input.data(), length);
+        const std::list<char> list(data.begin(), data.end());
+
+        REQUIRE(hash::sipHash13(data, key) == hash::sipHash13(list.begin(), list.end(), key));
+        REQUIRE(hash::sipHash24(data, key) == hash::sipHash24(list.begin(), list.end(), key));
+    }
+}
+
+TEST_CASE("Keyed hasher", "[siphash]") {
+    REQUIRE(hash::processKey() == hash::processKey());
+    REQUIRE(hash::processKey() != hash::SipKey{});
+
+    const hash::KeyedHasher hasher;
+    REQUIRE(hasher("foobar") == hasher(std::string("foobar")));
+    REQUIRE(hasher("foobar") == hash::sipHash13("foobar", hash::processKey()));
+
+    const hash::KeyedHasher first(hash::SipKey{1, 2});
+    const hash::KeyedHasher second(hash::SipKey{3, 4});
+    REQUIRE(first("foobar") != second("foobar"));
+    REQUIRE(first(uint64_t(42)) != second(uint64_t(42)));
+    REQUIRE(first(42) == first(42));
+}
+
+TEST_CASE("Keyed hasher in FlatHashMap", "[siphash]") {
+    hash::FlatHashMap<std::string, int, hash::KeyedHasher> strings;
+    for (int i = 0; i < 1000; ++i) {
+        strings[std::to_string(i)] = i;
+    }
+    REQUIRE(strings.size() == 1000);
+    REQUIRE(strings.at(std::string_view("123")) == 123);
+    REQUIRE_FALSE(strings.contains("1000"));
+
+    hash::FlatHashMap<uint32_t, int, hash::KeyedHasher> integers(0, hash::KeyedHasher(hash::SipKey{5, 6}));
+    for (uint32_t i = 0; i < 1000; ++i) {
+        integers[i * 4096] = static_cast<int>(i);
+    }
+    for (uint32_t i = 0; i < 1000; ++i) {
+        REQUIRE(integers.at(i * 4096) == static_cast<int>(i));
+    }
+}
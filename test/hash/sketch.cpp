@@ -0,0 +1,115 @@
+#include "sketch.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+std::string key(size_t index) { return "user" + std::to_string(index); }
+} // namespace
+
+TEST_CASE("HyperLogLog small sets are exact", "[sketch]") {
+    hash::HyperLogLog sketch;
+    REQUIRE(sketch.estimate() == 0);
+
+    for (size_t i = 0; i < 1000; ++i) {
+        sketch.insert(key(i));
+        sketch.insert(key(i));
+    }
+    REQUIRE(sketch.isSparse());
+    REQUIRE(std::round(sketch.estimate()) == 1000);
+}
+
+TEST_CASE("HyperLogLog dense estimate", "[sketch]") {
+    for (const unsigned precision : {10u, 14u}) {
+        hash::HyperLogLog sketch(precision);
+        const double error = 1.04 / std::sqrt(static_cast<double>(1u << precision));
+
+        size_t inserted = 0;
+        for (const size_t count : {5000, 50000, 500000}) {
+            for (; inserted < count; ++inserted) {
+                sketch.insert(key(inserted));
+            }
+            REQUIRE_FALSE(sketch.isSparse());
+            REQUIRE(std::abs(sketch.estimate() / static_cast<double>(count) - 1) < 4 * error);
+        }
+    }
+
+    REQUIRE_THROWS_AS(hash::HyperLogLog(3), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::HyperLogLog(19), std::invalid_argument);
+}
+
+TEST_CASE("HyperLogLog merge", "[sketch]") {
+    // Overlapping per thread style parts, one stays sparse and one goes dense
+    std::vector<hash::HyperLogLog> parts(3);
+    for (size_t i = 0; i < 100; ++i) {
+        parts[0].insert(key(i));
+    }
+    for (size_t i = 50; i < 200000; ++i) {
+        parts[1].insert(key(i));
+    }
+    for (size_t i = 100000; i < 300000; ++i) {
+        parts[2].insert(key(i));
+    }
+
+    hash::HyperLogLog all;
+    for (size_t i = 0; i < 300000; ++i) {
+        all.insert(key(i));
+    }
+
+    hash::HyperLogLog merged;
+    for (const hash::HyperLogLog& part : parts) {
+        merged.merge(part);
+    }
+    REQUIRE(merged.estimate() == all.estimate());
+
+    hash::HyperLogLog sparse;
+    sparse.merge(parts[0]);
+    sparse.merge(sparse);
+    REQUIRE(sparse.isSparse());
+    REQUIRE(std::round(sparse.estimate()) == 100);
+
+    REQUIRE_THROWS_AS(merged.merge(hash::HyperLogLog(12)), std::invalid_argument);
+}
+
+TEST_CASE("Count-Min sketch", "[sketch]") {
+    hash::CountMinSketch sketch = hash::makeCountMinSketch(0.001, 0.01);
+    REQUIRE(sketch.width() == 2719);
+    REQUIRE(sketch.depth() == 5);
+
+    // Zipf-like counts, key i occurs 10000 / (i + 1) times
+    std::vector<uint64_t> counts;
+    for (size_t i = 0; i < 5000; ++i) {
+        counts.push_back(10000 / (i + 1));
+        sketch.insert(key(i), counts.back());
+    }
+
+    const uint64_t bound = static_cast<uint64_t>(0.001 * static_cast<double>(sketch.totalCount()));
+    for (size_t i = 0; i < counts.size(); ++i) {
+        const uint64_t estimate = sketch.estimate(key(i));
+        REQUIRE(estimate >= counts[i]);
+        REQUIRE(estimate <= counts[i] + bound);
+    }
+    REQUIRE(sketch.estimate(key(0)) == 10000);
+}
+
+TEST_CASE("Count-Min sketch merge", "[sketch]") {
+    hash::CountMinSketch first(1024, 4, 7);
+    hash::CountMinSketch second(1024, 4, 7);
+    for (size_t i = 0; i < 2000; ++i) {
+        first.insert(key(i % 100));
+        second.insert(key(i % 300));
+    }
+
+    first.merge(second);
+    REQUIRE(first.totalCount() == 4000);
+    for (size_t i = 0; i < 300; ++i) {
+        const uint64_t expected = (i < 100 ? 20 : 0) + (i < 200 ? 7 : 6);
+        REQUIRE(first.estimate(key(i)) >= expected);
+    }
+
+    REQUIRE_THROWS_AS(first.merge(hash::CountMinSketch(1024, 4, 8)), std::invalid_argument);
+    REQUIRE_THROWS_AS(hash::CountMinSketch(0, 4), std::invalid_argument);
+}
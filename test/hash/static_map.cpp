@@ -0,0 +1,78 @@
+#include "static_map.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#if __has_include("inline_string.h")
+#include "inline_string.h"
+#endif
+
+namespace {
+constexpr auto verbs = hash::makeStaticMap<int>({
+    {"GET", 1},
+    {"PUT", 2},
+    {"POST", 3},
+    {"DELETE", 4},
+    {"HEAD", 5},
+    {"OPTIONS", 6},
+    {"PATCH", 7},
+});
+
+constexpr size_t KeyCount = 500;
+constexpr size_t KeyLength = 4;
+
+// "k000k001..." so that the generated keys have static storage
+constexpr auto keyStorage = [] {
+    std::array<char, KeyCount * KeyLength> data{};
+    for (size_t i = 0; i < KeyCount; ++i) {
+        data[i * KeyLength] = 'k';
+        data[i * KeyLength + 1] = static_cast<char>('0' + i / 100);
+        data[i * KeyLength + 2] = static_cast<char>('0' + i / 10 % 10);
+        data[i * KeyLength + 3] = static_cast<char>('0' + i % 10);
+    }
+    return data;
+}();
+
+constexpr std::string_view generatedKey(size_t i) { return {keyStorage.data() + i * KeyLength, KeyLength}; }
+
+constexpr auto generated = []() consteval {
+    std::pair<std::string_view, size_t> entries[KeyCount];
+    for (size_t i = 0; i < KeyCount; ++i) {
+        entries[i] = {generatedKey(i), i};
+    }
+    return hash::makeStaticMap<size_t>(entries);
+}();
+} // namespace
+
+TEST_CASE("Lookup", "[static_map]") {
+    static_assert(verbs.at("POST") == 3);
+    static_assert(verbs.find("TRACE") == nullptr);
+
+    REQUIRE(verbs.size() == 7);
+    for (const auto& [key, value] : verbs) {
+        REQUIRE(verbs.at(key) == value);
+    }
+
+    REQUIRE(*verbs.find(std::string("PATCH")) == 7);
+    REQUIRE_FALSE(verbs.contains("get"));
+    REQUIRE_FALSE(verbs.contains(""));
+    REQUIRE_FALSE(verbs.contains("GETS"));
+    REQUIRE_THROWS_AS(verbs.at("CONNECT"), std::out_of_range);
+}
+
+TEST_CASE("Larger key sets", "[static_map]") {
+    for (size_t i = 0; i < KeyCount; ++i) {
+        REQUIRE(generated.at(generatedKey(i)) == i);
+    }
+    REQUIRE_FALSE(generated.contains("k500"));
+    REQUIRE_FALSE(generated.contains("x000"));
+}
+
+#if __has_include("inline_string.h")
+TEST_CASE("InlineString keys", "[static_map]") {
+    constexpr str::InlineString<8> key("DELETE");
+    static_assert(verbs.at(key) == 4);
+    REQUIRE(verbs.at(key) == 4);
+}
+#endif
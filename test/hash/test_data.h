@@ -0,0 +1,46 @@
+#pragma once
+
+#include <random>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Inputs shared by the hash tests
+namespace test {
+
+inline std::vector<uint8_t> randomBytes(size_t count, uint32_t seed) {
+    std::mt19937_64 random(seed);
+    std::vector<uint8_t> bytes(count);
+    for (uint8_t& byte : bytes) {
+        byte = static_cast<uint8_t>(random());
+    }
+    return bytes;
+}
+
+// A fixed byte pattern, the XXH3 and CRC32C reference values are computed over it
+inline std::string makeInput(size_t length) {
+    std::string input;
+    for (size_t i = 0; i < length; ++i) {
+        input.push_back(static_cast<char>(i * 131 + 7));
+    }
+    return input;
+}
+
+// Keys of arbitrary bytes, their lengths cycle through minLength to minLength + 96 so every tail size comes up
+inline std::vector<std::string> makeKeys(size_t count, size_t minLength = 0) {
+    std::vector<std::string> keys;
+    uint32_t state = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        std::string key;
+        const size_t length = minLength + (i * 7) % 97;
+        for (size_t j = 0; j < length; ++j) {
+            state = state * 1103515245 + 12345;
+            key.push_back(static_cast<char>(state >> 16));
+        }
+        keys.push_back(std::move(key));
+    }
+    return keys;
+}
+
+} // namespace test
@@ -0,0 +1,74 @@
+#include "tree_hash.h"
+
+#include "test_data.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+TEST_CASE("Tree hash layout", "[tree_hash]") {
+    using namespace hash::detail::tree;
+
+    const std::vector<uint8_t> data = test::randomBytes(3 * hash::TreeHashChunkSize + 1000, 1);
+    const std::span<const uint8_t> bytes(data);
+
+    // Three full leaves and a partial one, combined as ((0, 1), (2, 3))
+    std::vector<uint64_t> leaves;
+    for (size_t offset = 0; offset < bytes.size(); offset += hash::TreeHashChunkSize) {
+        const auto chunk = bytes.subspan(offset, std::min(hash::TreeHashChunkSize, bytes.size() - offset));
+        leaves.push_back(hash::xxh3(chunk.begin(), chunk.end(), LeafSeed));
+    }
+    REQUIRE(leaves.size() == 4);
+    const uint64_t root =
+        combine(combine(leaves[0], leaves[1], NodeSeed), combine(leaves[2], leaves[3], NodeSeed), NodeSeed);
+    REQUIRE(hash::hashBuffer(bytes, 1) == combine(root, bytes.size(), RootSeed));
+
+    // An odd leaf moves up unchanged
+    const auto three = bytes.first(2 * hash::TreeHashChunkSize + 10);
+    const auto tail = three.subspan(2 * hash::TreeHashChunkSize);
+    const uint64_t pair = combine(leaves[0], leaves[1], NodeSeed);
+    const uint64_t odd = combine(pair, hash::xxh3(tail.begin(), tail.end(), LeafSeed), NodeSeed);
+    REQUIRE(hash::hashBuffer(three, 1) == combine(odd, three.size(), RootSeed));
+
+    REQUIRE(hash::hashBuffer({}, 1) == combine(hash::xxh3(bytes.begin(), bytes.begin(), LeafSeed), 0, RootSeed));
+
+    // Digests are combined as little endian bytes
+    const std::array<uint8_t, 16> pairBytes = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    REQUIRE(combine(0x0706050403020100ull, 0x0f0e0d0c0b0a0908ull, NodeSeed) ==
+            hash::xxh3(pairBytes.begin(), pairBytes.end(), NodeSeed));
+}
+
+TEST_CASE("Tree hash is independent of the thread count", "[tree_hash]") {
+    const std::vector<uint8_t> data = test::randomBytes(13 * hash::TreeHashChunkSize + 12345, 2);
+
+    const uint64_t expected = hash::hashBuffer(data, 1);
+    for (const unsigned threads : {2u, 3u, 8u, 0u}) {
+        REQUIRE(hash::hashBuffer(data, threads) == expected);
+    }
+
+    std::vector<uint8_t> changed = data;
+    changed[7 * hash::TreeHashChunkSize + 5] ^= 1;
+    REQUIRE(hash::hashBuffer(changed, 4) != expected);
+
+    // A trailing zero byte is a different input
+    changed = data;
+    changed.push_back(0);
+    REQUIRE(hash::hashBuffer(changed, 4) != expected);
+}
+
+TEST_CASE("Tree hash of a file", "[tree_hash]") {
+    const std::vector<uint8_t> data = test::randomBytes(2 * hash::TreeHashChunkSize + 77, 3);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "cpputils_tree_hash_test.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    const uint64_t digest = hash::hashFile(path, 2);
+    std::filesystem::remove(path);
+
+    REQUIRE(digest == hash::hashBuffer(data, 1));
+}
@@ -0,0 +1,60 @@
+#include "xxhash.h"
+
+#include "test_data.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <list>
+#include <string>
+
+namespace {
+struct Reference {
+    size_t length;
+    uint64_t unseeded;
+    uint64_t seeded;
+};
+
+// Covers every length class: empty, 1-3, 4-8, 9-16, 17-128, 129-240 and the striped long path
+constexpr Reference References[] = {
+    {0, 0x2d06800538d394c2, 0x602b0e2cd6662c8b},    {1, 0x4c5cca45d0f4811f, 0x2f3acd3805f81de3},
+    {3, 0x6e3e2670e61106ac, 0xbc74611d87f659e0},    {4, 0x5c4c63133443d03f, 0x6c3753177c607de4},
+    {8, 0xf9fd4dd0b04d78f5, 0xbc72d0531396303f},    {9, 0x7c20df9712c26edf, 0x93c5aa006102daf5},
+    {16, 0x86abf6baccea0858, 0x69d001b16ecf450a},   {17, 0xb58bf5dc5022d071, 0xb7c99d19be27eb69},
+    {64, 0x1291d2d4042330dd, 0x543fa55d8db03991},   {128, 0x10d17f72c0ccba41, 0x49b81c6e0abb9305},
+    {129, 0x1648bdc3db49d1a2, 0x5e3831b221810b00},  {200, 0xc0fbc0f4e181c826, 0x83264818fb531769},
+    {240, 0xb6cfaf343fab81e6, 0x76a73ec26433f82c},  {241, 0x956cae592c67279e, 0x2be236ba3bacf75c},
+    {1024, 0x70bd377d9574f4bb, 0xd8cf6b464541f232}, {1025, 0x66c4487c41e127a7, 0x8dc3a55e9c26d886},
+    {2048, 0x8b46caa67dab3a30, 0x9f2f0261a2592b60}, {4999, 0xc3af6109daa0965b, 0x6df2995fa7bd1d25},
+};
+
+constexpr uint64_t Seed = 0x9e3779b97f4a7c15;
+} // namespace
+
+TEST_CASE("XXH3 reference values", "[xxhash]") {
+    REQUIRE(hash::xxh3("") == 0x2d06800538d394c2);
+    REQUIRE(hash::xxh3("a") == 0xe6c632b61e964e1f);
+    REQUIRE(hash::xxh3("foobar") == 0xd78fda63144c5c84);
+    REQUIRE(hash::xxh3("foobar", 42) == 0x86086dccd96b61fe);
+
+    static_assert(hash::xxh3("foobar") == 0xd78fda63144c5c84);
+    static_assert(hash::xxh3("foobar", 42) == 0x86086dccd96b61fe);
+
+    const std::string input = test::makeInput(5000);
+    for (const Reference& reference : References) {
+        const std::string_view data(input.data(), reference.length);
+        REQUIRE(hash::xxh3(data) == reference.unseeded);
+        REQUIRE(hash::xxh3(data, Seed) == reference.seeded);
+    }
+}
+
+TEST_CASE("XXH3 contiguous and non-contiguous input agree", "[xxhash]") {
+    const std::string input = test::makeInput(2100);
+
+    for (size_t length : {0, 2, 7, 15, 33, 150, 239, 300, 1100, 2100}) {
+        const std::string_view data(input.data(), length);
+        const std::list<char> list(data.begin(), data.end());
+
+        REQUIRE(hash::xxh3(data) == hash::xxh3(list.begin(), list.end()));
+        REQUIRE(hash::xxh3(data, Seed) == hash::xxh3(list.begin(), list.end(), Seed));
+    }
+}
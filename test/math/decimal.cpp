@@ -0,0 +1,232 @@
+#include "decimal.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+template <int Scale> math::Decimal<Scale> parse(std::string_view text) {
+    math::Decimal<Scale> value;
+    const std::from_chars_result result = math::fromChars(text.data(), text.data() + text.size(), value);
+    REQUIRE(result.ec == std::errc());
+    REQUIRE(result.ptr == text.data() + text.size());
+    return value;
+}
+
+template <int Scale> std::string format(const math::Decimal<Scale>& value) {
+    char buffer[48];
+    const std::to_chars_result result = math::toChars(buffer, buffer + sizeof(buffer), value);
+    REQUIRE(result.ec == std::errc());
+    return std::string(buffer, result.ptr);
+}
+
+#if defined(CPPUTILS_INT128_BUILTIN) && defined(CPPUTILS_UINT128_BUILTIN)
+using Builtin = unsigned __int128;
+
+// lhs * rhs / divisor rounded half to even, one bit at a time, false when the quotient does not fit
+bool referenceMultiplyDivide(Builtin lhs, Builtin rhs, Builtin divisor, Builtin& result) {
+    Builtin high = 0;
+    Builtin low = 0;
+    for (int bit = 127; bit >= 0; --bit) {
+        high = (high << 1) | (low >> 127);
+        low <<= 1;
+        if ((rhs >> bit) & 1) {
+            const Builtin sum = low + lhs;
+            high += sum < low ? 1 : 0;
+            low = sum;
+        }
+    }
+
+    Builtin quotient = 0;
+    Builtin remainder = 0;
+    for (int bit = 255; bit >= 0; --bit) {
+        const bool carry = (remainder >> 127) != 0;
+        remainder = (remainder << 1) | ((bit >= 128 ? high >> (bit - 128) : low >> bit) & 1);
+        if ((quotient >> 127) != 0) {
+            return false;
+        }
+        quotient <<= 1;
+        if (carry || remainder >= divisor) {
+            remainder -= divisor;
+            quotient |= 1;
+        }
+    }
+
+    if (remainder > divisor - remainder || (remainder == divisor - remainder && (quotient & 1) != 0)) {
+        if (++quotient == 0) {
+            return false;
+        }
+    }
+    result = quotient;
+    return true;
+}
+
+template <int Scale> void requireMatchesReference(uint64_t seed) {
+    using Decimal = math::Decimal<Scale>;
+    const Builtin power = static_cast<Builtin>(math::detail::decimal::PowersOf10[Scale]);
+    const Builtin limit = Builtin(1) << 127;
+
+    const auto expected = [&](__int128 lhs, __int128 rhs, Builtin product, Builtin divisor, Decimal& result) {
+        const bool negative = (lhs < 0) != (rhs < 0);
+        const Builtin lhsMagnitude = lhs < 0 ? -static_cast<Builtin>(lhs) : static_cast<Builtin>(lhs);
+        Builtin quotient = 0;
+        const bool fits = referenceMultiplyDivide(lhsMagnitude, product, divisor, quotient);
+        if (!fits || quotient > limit - (negative ? 0 : 1)) {
+            return false;
+        }
+        result = Decimal::fromRaw(static_cast<__int128>(negative ? -quotient : quotient));
+        return true;
+    };
+
+    std::mt19937_64 random(seed);
+    const auto randomRaw = [&] {
+        const Builtin bits = (Builtin(random()) << 64) | random();
+        const __int128 value = static_cast<__int128>(bits >> (1 + random() % 127));
+        return random() % 2 == 0 ? value : -value;
+    };
+
+    for (size_t i = 0; i < 20000; ++i) {
+        const __int128 lhs = randomRaw();
+        const __int128 rhs = randomRaw();
+        const Builtin rhsMagnitude = rhs < 0 ? -static_cast<Builtin>(rhs) : static_cast<Builtin>(rhs);
+
+        Decimal product;
+        if (expected(lhs, rhs, rhsMagnitude, power, product)) {
+            REQUIRE(Decimal::fromRaw(lhs) * Decimal::fromRaw(rhs) == product);
+        } else {
+            REQUIRE_THROWS_AS(Decimal::fromRaw(lhs) * Decimal::fromRaw(rhs), std::overflow_error);
+        }
+
+        if (rhs == 0) {
+            continue;
+        }
+        Decimal quotient;
+        if (expected(lhs, rhs, power, rhsMagnitude, quotient)) {
+            REQUIRE(Decimal::fromRaw(lhs) / Decimal::fromRaw(rhs) == quotient);
+        } else {
+            REQUIRE_THROWS_AS(Decimal::fromRaw(lhs) / Decimal::fromRaw(rhs), std::overflow_error);
+        }
+
+        REQUIRE(parse<Scale>(format(Decimal::fromRaw(lhs))).raw() == lhs);
+    }
+}
+#endif
+} // namespace
+
+TEST_CASE("Decimal arithmetic", "[decimal]") {
+    using Money = math::Decimal<2>;
+
+    REQUIRE(parse<2>("0.1") + parse<2>("0.2") == parse<2>("0.3"));
+    REQUIRE(Money(5).raw() == 500);
+    REQUIRE(Money(-5) - Money(7) == Money(-12));
+    REQUIRE(-Money(3) == Money(-3));
+    REQUIRE(Money(1) < parse<2>("1.01"));
+
+    // Half to even on products and quotients
+    REQUIRE(parse<2>("1.25") * parse<2>("0.5") == parse<2>("0.62"));
+    REQUIRE(parse<2>("1.35") * parse<2>("0.5") == parse<2>("0.68"));
+    REQUIRE(parse<2>("-1.25") * parse<2>("0.5") == parse<2>("-0.62"));
+    REQUIRE(parse<2>("1.27") * parse<2>("0.5") == parse<2>("0.64"));
+    REQUIRE(Money(1) / Money(8) == parse<2>("0.12"));
+    REQUIRE(Money(3) / Money(8) == parse<2>("0.38"));
+    REQUIRE(Money(-2) / Money(3) == parse<2>("-0.67"));
+    REQUIRE(math::Decimal<4>(1) / math::Decimal<4>(3) == parse<4>("0.3333"));
+
+    Money total = 10;
+    total += Money(5);
+    total -= Money(1);
+    total *= Money(2);
+    total /= Money(4);
+    REQUIRE(total == Money(7));
+
+    static_assert(math::Decimal<2>(1) / math::Decimal<2>(3) == math::Decimal<2>::fromRaw(33));
+    static_assert(math::Decimal<38>(1).raw() == static_cast<int128_t>(math::detail::decimal::PowersOf10[38]));
+}
+
+TEST_CASE("Decimal rescaling", "[decimal]") {
+    REQUIRE(math::Decimal<2>(parse<4>("1.2345")) == parse<2>("1.23"));
+    REQUIRE(math::Decimal<2>(parse<4>("1.2350")) == parse<2>("1.24"));
+    REQUIRE(math::Decimal<2>(parse<4>("1.2250")) == parse<2>("1.22"));
+    REQUIRE(math::Decimal<2>(parse<4>("-1.2251")) == parse<2>("-1.23"));
+    REQUIRE(math::Decimal<0>(parse<30>("0.5")) == math::Decimal<0>(0));
+    REQUIRE(math::Decimal<0>(parse<30>("1.5")) == math::Decimal<0>(2));
+    REQUIRE(math::Decimal<8>(parse<2>("-3.07")).raw() == -307000000);
+
+    REQUIRE_THROWS_AS(math::Decimal<38>(2), std::overflow_error);
+    REQUIRE_THROWS_AS(math::Decimal<30>(math::Decimal<0>(std::numeric_limits<int64_t>::max())), std::overflow_error);
+}
+
+TEST_CASE("Decimal overflow", "[decimal]") {
+    using Decimal = math::Decimal<6>;
+    const Decimal largest = Decimal::fromRaw(std::numeric_limits<int128_t>::max());
+    const Decimal smallest = Decimal::fromRaw(std::numeric_limits<int128_t>::min());
+    const Decimal unit = Decimal::fromRaw(1);
+
+    REQUIRE((largest - unit) + unit == largest);
+    REQUIRE((smallest + unit) - unit == smallest);
+    REQUIRE_THROWS_AS(largest + unit, std::overflow_error);
+    REQUIRE_THROWS_AS(smallest - unit, std::overflow_error);
+    REQUIRE_THROWS_AS(-smallest, std::overflow_error);
+    REQUIRE_THROWS_AS(largest * Decimal(2), std::overflow_error);
+    REQUIRE_THROWS_AS(largest / parse<6>("0.5"), std::overflow_error);
+    REQUIRE(smallest / Decimal(-2) == Decimal::fromRaw(int128_t(1) << 126));
+    REQUIRE_THROWS_AS(Decimal(1) / Decimal(0), std::domain_error);
+}
+
+TEST_CASE("Decimal formatting and parsing", "[decimal]") {
+    REQUIRE(format(parse<2>("12.5")) == "12.50");
+    REQUIRE(format(parse<3>("-0.007")) == "-0.007");
+    REQUIRE(format(parse<2>("-.5")) == "-0.50");
+    REQUIRE(format(parse<2>("5.")) == "5.00");
+    REQUIRE(format(parse<0>("42")) == "42");
+    REQUIRE(format(math::Decimal<2>(0)) == "0.00");
+    REQUIRE(format(math::Decimal<38>::fromRaw(1)) == "0.00000000000000000000000000000000000001");
+    REQUIRE(format(math::Decimal<2>::fromRaw(std::numeric_limits<int128_t>::min())) ==
+            "-1701411834604692317316873037158841057.28");
+
+    // Digits past the scale are rounded half to even
+    REQUIRE(parse<2>("1.005") == parse<2>("1.00"));
+    REQUIRE(parse<2>("1.015") == parse<2>("1.02"));
+    REQUIRE(parse<2>("1.0050001") == parse<2>("1.01"));
+    REQUIRE(parse<2>("-1.009") == parse<2>("-1.01"));
+    REQUIRE(parse<20>("000000000000000000000000000000000001.5") == math::Decimal<20>(3) / math::Decimal<20>(2));
+
+    math::Decimal<2> value = 42;
+    const auto fromChars = [&](std::string_view text) {
+        return math::fromChars(text.data(), text.data() + text.size(), value);
+    };
+    REQUIRE(fromChars("").ec == std::errc::invalid_argument);
+    REQUIRE(fromChars("-").ec == std::errc::invalid_argument);
+    REQUIRE(fromChars(".").ec == std::errc::invalid_argument);
+    REQUIRE(fromChars("+1").ec == std::errc::invalid_argument);
+    REQUIRE(fromChars("1701411834604692317316873037158841057.28").ec == std::errc::result_out_of_range);
+    REQUIRE(fromChars("1701411834604692317316873037158841057.275").ec == std::errc::result_out_of_range);
+    REQUIRE(value == math::Decimal<2>(42));
+    REQUIRE(fromChars("-1701411834604692317316873037158841057.28").ec == std::errc());
+    REQUIRE(fromChars("12.5x").ptr == std::string_view("12.5x").data() + 4);
+
+    char buffer[5];
+    REQUIRE(math::toChars(buffer, buffer + sizeof(buffer), parse<2>("-12.25")).ec == std::errc::value_too_large);
+    REQUIRE(math::toChars(buffer, buffer + sizeof(buffer), parse<2>("12.25")).ec == std::errc());
+
+#if __has_include("inline_string.h")
+    static_assert(math::toChars(math::Decimal<4>(-3) / math::Decimal<4>(7)).toStringView() == "-0.4286");
+    REQUIRE(math::toChars(math::Decimal<38>::fromRaw(std::numeric_limits<int128_t>::min())).toStringView() ==
+            "-1.70141183460469231731687303715884105728");
+#endif
+}
+
+#if defined(CPPUTILS_INT128_BUILTIN) && defined(CPPUTILS_UINT128_BUILTIN)
+TEST_CASE("Decimal matches the reference rounding", "[decimal]") {
+    requireMatchesReference<0>(1);
+    requireMatchesReference<2>(2);
+    requireMatchesReference<9>(3);
+    requireMatchesReference<19>(4);
+    requireMatchesReference<20>(5);
+    requireMatchesReference<38>(6);
+}
+#endif
@@ -0,0 +1,118 @@
+#include "divider.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// Small values, powers of two and their neighbours, the extremes and random values of every magnitude
+template <typename T> std::vector<T> testValues(uint64_t seed) {
+    using Limits = std::numeric_limits<T>;
+    std::vector<T> values = {T(1),   T(2),    T(3),         T(5),  T(6), T(7), T(10),
+                             T(641), T(1000), Limits::max(), T(Limits::max() - 1)};
+    for (int bit = 2; bit < Limits::digits; ++bit) {
+        const T power = T(1) << bit;
+        values.insert(values.end(), {T(power - 1), power, T(power + 1)});
+    }
+    if constexpr (Limits::is_signed) {
+        const size_t positive = values.size();
+        for (size_t i = 0; i < positive; ++i) {
+            values.push_back(T(-values[i]));
+        }
+        values.insert(values.end(), {Limits::min(), T(Limits::min() + 1)});
+    }
+
+    std::mt19937_64 random(seed);
+    for (size_t i = 0; i < 200; ++i) {
+        T value = static_cast<T>(random());
+        if constexpr (sizeof(T) > sizeof(uint64_t)) {
+            value = T(value << 64) | T(random());
+        }
+        value >>= random() % Limits::digits;
+        values.push_back(value == 0 ? T(1) : value);
+    }
+    return values;
+}
+
+template <typename T> void requireMatchesBuiltin() {
+    const std::vector<T> divisors = testValues<T>(1);
+    std::vector<T> dividends = testValues<T>(2);
+    dividends.push_back(0);
+
+    std::vector<T> quotients(dividends.size());
+    for (const T divisor : divisors) {
+        const math::Divider<T> divider(divisor);
+        REQUIRE(divider.divisor() == divisor);
+
+        divider.divide(dividends, quotients);
+        for (size_t i = 0; i < dividends.size(); ++i) {
+            const T dividend = dividends[i];
+            // The one signed quotient that overflows is not defined for the builtin division
+            if constexpr (std::numeric_limits<T>::is_signed) {
+                if (dividend == std::numeric_limits<T>::min() && divisor == T(-1)) {
+                    continue;
+                }
+            }
+            REQUIRE(dividend / divider == dividend / divisor);
+            REQUIRE(dividend % divider == dividend % divisor);
+            REQUIRE(quotients[i] == dividend / divisor);
+        }
+    }
+}
+} // namespace
+
+TEST_CASE("Divider matches the builtin division", "[divider]") {
+    requireMatchesBuiltin<uint32_t>();
+    requireMatchesBuiltin<int32_t>();
+    requireMatchesBuiltin<uint64_t>();
+    requireMatchesBuiltin<int64_t>();
+#ifdef CPPUTILS_UINT128
+    requireMatchesBuiltin<uint128_t>();
+#endif
+#if defined(CPPUTILS_INT128) && defined(CPPUTILS_UINT128)
+    requireMatchesBuiltin<int128_t>();
+#endif
+}
+
+TEST_CASE("Divider is constant evaluated", "[divider]") {
+    static_assert(uint32_t(100) / math::Divider<uint32_t>(7) == 14);
+    static_assert(uint32_t(0xffffffff) / math::Divider<uint32_t>(7) == 0x24924924);
+    static_assert(int32_t(-100) / math::Divider<int32_t>(7) == -14);
+    static_assert(int64_t(-100) % math::Divider<int64_t>(-8) == -4);
+    static_assert(uint64_t(0xffffffffffffffff) / math::Divider<uint64_t>(3) == 0x5555555555555555);
+}
+
+TEST_CASE("Divider batches", "[divider]") {
+    std::mt19937 random(3);
+    for (const uint32_t divisor : {1u, 4u, 7u, 10u, 1000u, 0x80000001u}) {
+        const math::Divider<uint32_t> divider(divisor);
+        // Lengths that leave every possible tail after the vector loop
+        for (size_t size = 0; size < 12; ++size) {
+            std::vector<uint32_t> values(size);
+            for (uint32_t& value : values) {
+                value = static_cast<uint32_t>(random());
+            }
+            std::vector<uint32_t> quotients(size);
+            divider.divide(values, quotients);
+            for (size_t i = 0; i < size; ++i) {
+                REQUIRE(quotients[i] == values[i] / divisor);
+            }
+        }
+    }
+
+    const std::vector<int64_t> values = {-9, -8, 7, 0};
+    std::vector<int64_t> quotients(values.size());
+    math::Divider<int64_t>(-4).divide(values, quotients);
+    REQUIRE(quotients == std::vector<int64_t>{2, 2, -1, 0});
+
+    std::vector<int64_t> shorter(values.size() - 1);
+    REQUIRE_THROWS_AS(math::Divider<int64_t>(3).divide(values, shorter), std::invalid_argument);
+}
+
+TEST_CASE("Divider by zero", "[divider]") {
+    REQUIRE_THROWS_AS(math::Divider<uint32_t>(0), std::domain_error);
+    REQUIRE_THROWS_AS(math::Divider<int64_t>(0), std::domain_error);
+}
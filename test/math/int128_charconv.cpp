@@ -0,0 +1,142 @@
+#include "int128_charconv.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+// The slow formatting the fast path replaces
+std::string reference(uint128_t value) {
+    std::string digits;
+    do {
+        digits.insert(digits.begin(), static_cast<char>('0' + static_cast<int>(value % 10)));
+        value /= 10;
+    } while (value != 0);
+    return digits;
+}
+
+std::string reference(int128_t value) {
+    return value < 0 ? "-" + reference(uint128_t(0) - static_cast<uint128_t>(value))
+                     : reference(static_cast<uint128_t>(value));
+}
+
+// Powers of ten and their neighbours around every chunk boundary, the extremes and random values of every magnitude
+std::vector<uint128_t> testValues() {
+    std::vector<uint128_t> values = {0, 1, 9, std::numeric_limits<uint128_t>::max()};
+    uint128_t power = 1;
+    for (int digits = 1; digits < 39; ++digits) {
+        power *= 10;
+        values.insert(values.end(), {power - 1, power, power + 1});
+    }
+
+    std::mt19937_64 random(5);
+    for (size_t i = 0; i < 2000; ++i) {
+        const uint128_t value = (uint128_t(random()) << 64) | uint128_t(random());
+        values.push_back(value >> (random() % 128));
+    }
+    return values;
+}
+
+template <typename T> std::string format(T value) {
+    char buffer[48];
+    const std::to_chars_result result = math::toChars(buffer, buffer + sizeof(buffer), value);
+    REQUIRE(result.ec == std::errc());
+    return std::string(buffer, result.ptr);
+}
+
+template <typename T>
+T parse(std::string_view text, std::errc expected = std::errc(), size_t used = std::string_view::npos) {
+    T value = 42;
+    const std::from_chars_result result = math::fromChars(text.data(), text.data() + text.size(), value);
+    REQUIRE(result.ec == expected);
+    REQUIRE(result.ptr == text.data() + std::min(used, text.size()));
+    return value;
+}
+
+constexpr bool roundTrips(std::string_view text) {
+    uint128_t value = 0;
+    math::fromChars(text.data(), text.data() + text.size(), value);
+    char buffer[39] = {};
+    const std::to_chars_result result = math::toChars(buffer, buffer + sizeof(buffer), value);
+    return std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)) == text;
+}
+} // namespace
+
+TEST_CASE("int128 charconv matches the reference", "[int128_charconv]") {
+    for (const uint128_t value : testValues()) {
+        const std::string text = reference(value);
+        REQUIRE(format(value) == text);
+        REQUIRE(parse<uint128_t>(text) == value);
+
+        const int128_t signedValue = static_cast<int128_t>(value);
+        const std::string signedText = reference(signedValue);
+        REQUIRE(format(signedValue) == signedText);
+        REQUIRE(parse<int128_t>(signedText) == signedValue);
+        REQUIRE(parse<int128_t>(reference(-(signedValue >> 1))) == -(signedValue >> 1));
+    }
+}
+
+TEST_CASE("int128 charconv limits", "[int128_charconv]") {
+    const std::string maxUnsigned = "340282366920938463463374607431768211455";
+    const std::string maxSigned = "170141183460469231731687303715884105727";
+    const std::string minSigned = "-170141183460469231731687303715884105728";
+
+    REQUIRE(format(std::numeric_limits<uint128_t>::max()) == maxUnsigned);
+    REQUIRE(format(std::numeric_limits<int128_t>::max()) == maxSigned);
+    REQUIRE(format(std::numeric_limits<int128_t>::min()) == minSigned);
+
+    REQUIRE(parse<uint128_t>(maxUnsigned) == std::numeric_limits<uint128_t>::max());
+    REQUIRE(parse<int128_t>(maxSigned) == std::numeric_limits<int128_t>::max());
+    REQUIRE(parse<int128_t>(minSigned) == std::numeric_limits<int128_t>::min());
+
+    // One past the limits is out of range, consumes the digits and leaves the value alone
+    REQUIRE(parse<uint128_t>("340282366920938463463374607431768211456", std::errc::result_out_of_range) == 42);
+    REQUIRE(parse<uint128_t>(maxUnsigned + "0", std::errc::result_out_of_range) == 42);
+    REQUIRE(parse<int128_t>("170141183460469231731687303715884105728", std::errc::result_out_of_range) == 42);
+    REQUIRE(parse<int128_t>("-170141183460469231731687303715884105729", std::errc::result_out_of_range) == 42);
+
+    // Leading zeros do not count against the limit
+    REQUIRE(parse<uint128_t>(std::string(50, '0') + maxUnsigned) == std::numeric_limits<uint128_t>::max());
+    REQUIRE(parse<uint128_t>(std::string(40, '0')) == 0);
+}
+
+TEST_CASE("int128 charconv errors", "[int128_charconv]") {
+    REQUIRE(parse<uint128_t>("", std::errc::invalid_argument, 0) == 42);
+    REQUIRE(parse<uint128_t>("x1", std::errc::invalid_argument, 0) == 42);
+    REQUIRE(parse<uint128_t>("-1", std::errc::invalid_argument, 0) == 42);
+    REQUIRE(parse<int128_t>("-", std::errc::invalid_argument, 0) == 42);
+    REQUIRE(parse<int128_t>("+1", std::errc::invalid_argument, 0) == 42);
+    REQUIRE(parse<int128_t>("--1", std::errc::invalid_argument, 0) == 42);
+
+    // Parsing stops at the first character that is not a digit, also past the vectorized blocks
+    REQUIRE(parse<uint128_t>("123abc", std::errc(), 3) == 123);
+    REQUIRE(parse<uint128_t>("12345678901234567890/", std::errc(), 20) == uint128_t(12345678901234567890u));
+    REQUIRE(parse<int128_t>("-1234567890123456:0", std::errc(), 17) == -1234567890123456);
+
+    char buffer[39];
+    REQUIRE(math::toChars(buffer, buffer + 2, uint128_t(123)).ec == std::errc::value_too_large);
+    REQUIRE(math::toChars(buffer, buffer, int128_t(-1)).ec == std::errc::value_too_large);
+    REQUIRE(math::toChars(buffer, buffer + 38, std::numeric_limits<uint128_t>::max()).ec == std::errc::value_too_large);
+    REQUIRE(math::toChars(buffer, buffer + 39, std::numeric_limits<uint128_t>::max()).ec == std::errc());
+}
+
+TEST_CASE("int128 charconv is constant evaluated", "[int128_charconv]") {
+    static_assert(roundTrips("0"));
+    static_assert(roundTrips("18446744073709551616"));
+    static_assert(roundTrips("340282366920938463463374607431768211455"));
+}
+
+#if __has_include("inline_string.h")
+TEST_CASE("int128 charconv into an inline string", "[int128_charconv]") {
+    static_assert(math::toChars(uint128_t(1) << 64).toStringView() == "18446744073709551616");
+    REQUIRE(math::toChars(std::numeric_limits<uint128_t>::max()).toStringView() ==
+            "340282366920938463463374607431768211455");
+    REQUIRE(math::toChars(std::numeric_limits<int128_t>::min()).toStringView() ==
+            "-170141183460469231731687303715884105728");
+}
+#endif
@@ -0,0 +1,212 @@
+#include "int128_portable.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+constexpr math::UInt128 MaxUnsigned = std::numeric_limits<math::UInt128>::max();
+constexpr math::Int128 MinSigned = std::numeric_limits<math::Int128>::min();
+constexpr math::Int128 MaxSigned = std::numeric_limits<math::Int128>::max();
+
+// Limb patterns that hit the carries, the sign bits and the corrections of the division
+std::vector<math::UInt128> testValues() {
+    const uint64_t limbs[] = {0, 1, 2, 3, 7, 0xffffffff, 0x100000000, 0x7fffffffffffffff, 0x8000000000000000,
+                              0xfffffffffffffffe, 0xffffffffffffffff, 0x123456789abcdef0};
+    std::vector<math::UInt128> values;
+    for (const uint64_t high : limbs) {
+        for (const uint64_t low : limbs) {
+            values.push_back(math::UInt128::fromBits(high, low));
+        }
+    }
+
+    std::mt19937_64 random(7);
+    for (size_t i = 0; i < 200; ++i) {
+        const uint64_t high = random() >> (random() % 64);
+        values.push_back(math::UInt128::fromBits(high, random()));
+    }
+    return values;
+}
+
+#ifdef __SIZEOF_INT128__
+unsigned __int128 toBuiltin(const math::UInt128& value) {
+    return (static_cast<unsigned __int128>(value.highBits()) << 64) | value.lowBits();
+}
+
+__int128 toBuiltin(const math::Int128& value) {
+    return static_cast<__int128>(toBuiltin(math::UInt128(value)));
+}
+#endif
+} // namespace
+
+TEST_CASE("Portable int128 constants", "[int128_portable]") {
+    static_assert(sizeof(math::UInt128) == 16);
+    static_assert(math::UInt128(1) << 64 == math::UInt128::fromBits(1, 0));
+    static_assert(MaxUnsigned + 1 == 0);
+    static_assert(math::Int128(-1) < math::Int128(0));
+    static_assert(math::UInt128(math::Int128(-1)) == MaxUnsigned);
+    static_assert(MinSigned - 1 == MaxSigned);
+    static_assert(MaxUnsigned / 10 == math::UInt128::fromBits(0x1999999999999999, 0x9999999999999999));
+    static_assert(math::Int128(-7) / 2 == -3);
+    static_assert(math::Int128(-7) % 2 == -1);
+    static_assert(math::divmod(math::Int128(-7), math::Int128(2)).remainder == -1);
+    static_assert(math::divmod(MaxUnsigned, math::UInt128(1) << 64).quotient == ~uint64_t(0));
+    static_assert((math::Int128(-256) >> 4) == -16);
+    static_assert(static_cast<uint32_t>(math::UInt128::fromBits(5, 0x1'0000'0007)) == 7);
+
+    REQUIRE(std::numeric_limits<math::Int128>::digits == 127);
+    REQUIRE(std::numeric_limits<math::UInt128>::digits == 128);
+    REQUIRE(std::numeric_limits<math::UInt128>::min() == 0);
+}
+
+TEST_CASE("Portable int128 conversions", "[int128_portable]") {
+    REQUIRE(math::Int128(int8_t(-5)).highBits() == ~uint64_t(0));
+    REQUIRE(math::Int128(uint64_t(-5)).highBits() == 0);
+    REQUIRE(static_cast<int64_t>(math::Int128(-5)) == -5);
+    REQUIRE(!math::UInt128());
+    REQUIRE(static_cast<bool>(math::UInt128::fromBits(1, 0)));
+
+    REQUIRE(static_cast<double>(math::UInt128(1) << 100) == 0x1p100);
+    REQUIRE(static_cast<double>(-(math::Int128(3) << 70)) == -0x3p70);
+    REQUIRE(static_cast<double>(MinSigned) == -0x1p127);
+    REQUIRE(math::UInt128(0x1p100) == math::UInt128(1) << 100);
+    REQUIRE(math::Int128(-0x5p80) == -(math::Int128(5) << 80));
+    REQUIRE(math::Int128(-12.75) == -12);
+
+    math::Int128 value = 10;
+    REQUIRE(value++ == 10);
+    REQUIRE(--value == 10);
+    value <<= 65;
+    value >>= 64;
+    REQUIRE(value == 20);
+}
+
+TEST_CASE("Portable int128 division by zero", "[int128_portable]") {
+    REQUIRE_THROWS_AS(math::UInt128(1) / 0, std::domain_error);
+    REQUIRE_THROWS_AS(math::Int128(1) % 0, std::domain_error);
+}
+
+#ifdef __SIZEOF_INT128__
+TEST_CASE("Portable int128 matches the builtin types", "[int128_portable]") {
+    const std::vector<math::UInt128> values = testValues();
+
+    for (const math::UInt128& lhs : values) {
+        const unsigned __int128 a = toBuiltin(lhs);
+        const __int128 sa = static_cast<__int128>(a);
+        const math::Int128 slhs(lhs);
+
+        REQUIRE(toBuiltin(-lhs) == -a);
+        REQUIRE(toBuiltin(~lhs) == ~a);
+        for (const unsigned shift : {0u, 1u, 13u, 63u, 64u, 65u, 100u, 127u}) {
+            REQUIRE(toBuiltin(lhs << shift) == a << shift);
+            REQUIRE(toBuiltin(lhs >> shift) == a >> shift);
+            REQUIRE(toBuiltin(slhs >> shift) == sa >> shift);
+        }
+
+        for (const math::UInt128& rhs : values) {
+            const unsigned __int128 b = toBuiltin(rhs);
+            const __int128 sb = static_cast<__int128>(b);
+            const math::Int128 srhs(rhs);
+
+            REQUIRE(toBuiltin(lhs + rhs) == a + b);
+            REQUIRE(toBuiltin(lhs - rhs) == a - b);
+            REQUIRE(toBuiltin(lhs * rhs) == a * b);
+            REQUIRE(toBuiltin(lhs & rhs) == (a & b));
+            REQUIRE(toBuiltin(lhs | rhs) == (a | b));
+            REQUIRE(toBuiltin(lhs ^ rhs) == (a ^ b));
+            REQUIRE((lhs < rhs) == (a < b));
+            REQUIRE((slhs < srhs) == (sa < sb));
+            REQUIRE((lhs == rhs) == (a == b));
+
+            if (b != 0) {
+                REQUIRE(toBuiltin(lhs / rhs) == a / b);
+                REQUIRE(toBuiltin(lhs % rhs) == a % b);
+
+                const math::DivMod<math::UInt128> result = math::divmod(lhs, rhs);
+                REQUIRE(toBuiltin(result.quotient) == a / b);
+                REQUIRE(toBuiltin(result.remainder) == a % b);
+                const math::DivMod<unsigned __int128> builtin = math::divmod(a, b);
+                REQUIRE(builtin.quotient == a / b);
+                REQUIRE(builtin.remainder == a % b);
+
+                // The one signed quotient that overflows wraps like the unsigned arithmetic it is made of
+                if (!(slhs == MinSigned && srhs == -1)) {
+                    REQUIRE(toBuiltin(slhs / srhs) == sa / sb);
+                    REQUIRE(toBuiltin(slhs % srhs) == sa % sb);
+
+                    const math::DivMod<__int128> signedBuiltin = math::divmod(sa, sb);
+                    REQUIRE(signedBuiltin.quotient == sa / sb);
+                    REQUIRE(signedBuiltin.remainder == sa % sb);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Portable 128 by 64 bit division", "[int128_portable]") {
+    std::mt19937_64 random(11);
+    for (size_t i = 0; i < 100000; ++i) {
+        const uint64_t divisor = std::max<uint64_t>(1, random() >> (random() % 64));
+        const uint64_t high = random() % divisor;
+        const uint64_t low = random();
+        const unsigned __int128 dividend = (static_cast<unsigned __int128>(high) << 64) | low;
+
+        uint64_t remainder = 0;
+        const uint64_t quotient = math::detail::int128::divideWide(high, low, divisor, remainder);
+        REQUIRE(quotient == static_cast<uint64_t>(dividend / divisor));
+        REQUIRE(remainder == static_cast<uint64_t>(dividend % divisor));
+    }
+
+    // The long division the instruction replaces on x86, with divisors whose digits trigger the estimate corrections
+    for (size_t i = 0; i < 200000; ++i) {
+        uint64_t divisor = std::max<uint64_t>(1, random() >> (random() % 64));
+        if (i % 4 == 1) {
+            divisor = (random() << 32) | (random() % 3 == 0 ? 0 : random() % 2 == 0 ? 0xffffffff : random() % 16);
+        } else if (i % 4 == 2) {
+            divisor = std::max<uint64_t>(1, (random() % 0x10000) << (random() % 48));
+        }
+        const uint64_t high = i % 8 == 3 ? divisor - 1 : random() % divisor;
+        const uint64_t low = i % 8 == 5 ? ~uint64_t(0) : i % 8 == 7 ? 0 : random();
+        const unsigned __int128 dividend = (static_cast<unsigned __int128>(high) << 64) | low;
+
+        uint64_t remainder = 0;
+        const uint64_t quotient = math::detail::int128::divideWidePortable(high, low, divisor, remainder);
+        REQUIRE(quotient == static_cast<uint64_t>(dividend / divisor));
+        REQUIRE(remainder == static_cast<uint64_t>(dividend % divisor));
+    }
+
+    // Division by invariant integers through a reciprocal
+    for (size_t i = 0; i < 1000; ++i) {
+        const uint64_t divisor = std::max<uint64_t>(1, random() >> (random() % 64));
+        const math::detail::int128::Reciprocal reciprocal = math::detail::int128::makeReciprocal(divisor);
+        for (size_t j = 0; j < 100; ++j) {
+            const uint64_t high = random() % divisor;
+            const uint64_t low = j < 2 ? ~uint64_t(0) * j : random();
+            const unsigned __int128 dividend = (static_cast<unsigned __int128>(high) << 64) | low;
+
+            uint64_t remainder = 0;
+            const uint64_t quotient = math::detail::int128::divideWide(high, low, reciprocal, remainder);
+            REQUIRE(quotient == static_cast<uint64_t>(dividend / divisor));
+            REQUIRE(remainder == static_cast<uint64_t>(dividend % divisor));
+        }
+    }
+
+    // The constant evaluated path is the portable long division
+    constexpr auto matches = [](uint64_t high, uint64_t low, uint64_t divisor) {
+        const unsigned __int128 dividend = (static_cast<unsigned __int128>(high) << 64) | low;
+        uint64_t remainder = 0;
+        const uint64_t quotient = math::detail::int128::divideWide(high, low, divisor, remainder);
+        return quotient == static_cast<uint64_t>(dividend / divisor) &&
+               remainder == static_cast<uint64_t>(dividend % divisor);
+    };
+    static_assert(matches(0, 100, 7));
+    static_assert(matches(0xfffffffffffffffe, ~uint64_t(0), ~uint64_t(0)));
+    static_assert(matches(1, 0, 3));
+    static_assert(matches(0x1234, 0x5678, 0x100000001));
+    static_assert(matches(0x7fffffff, 0x8000000000000000, 0x80000000ffffffff));
+    static_assert(matches(0xffffffff, 0, 0x100000000));
+}
+#endif
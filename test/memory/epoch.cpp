@@ -0,0 +1,155 @@
+#include "epoch.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+std::atomic<size_t> destroyed{0};
+
+struct Tracked {
+    ~Tracked() { destroyed.fetch_add(1, std::memory_order_relaxed); }
+};
+
+// Every collection advances the epoch at most once, and retired objects need two advances
+void collectAll() {
+    for (int i = 0; i < 3; ++i) {
+        memory::collectRetired();
+    }
+}
+} // namespace
+
+TEST_CASE("Retired objects are freed once no guard can see them", "[epoch]") {
+    collectAll();
+    destroyed = 0;
+
+    {
+        const memory::EpochGuard guard;
+        memory::retire(new Tracked());
+        collectAll();
+        REQUIRE(destroyed == 0);
+    }
+    collectAll();
+    REQUIRE(destroyed == 1);
+
+    // Without a guard nothing holds the objects back
+    for (int i = 0; i < 10; ++i) {
+        memory::retire(new Tracked());
+    }
+    collectAll();
+    REQUIRE(destroyed == 11);
+}
+
+TEST_CASE("Nested guards protect until the outermost ends", "[epoch]") {
+    collectAll();
+    destroyed = 0;
+
+    {
+        const memory::EpochGuard outer;
+        {
+            const memory::EpochGuard inner;
+            memory::retire(new Tracked());
+        }
+        collectAll();
+        REQUIRE(destroyed == 0);
+
+        {
+            const memory::EpochGuard inner;
+            collectAll();
+            REQUIRE(destroyed == 0);
+        }
+    }
+    collectAll();
+    REQUIRE(destroyed == 1);
+}
+
+TEST_CASE("Guards on other threads hold back retired objects", "[epoch]") {
+    collectAll();
+    destroyed = 0;
+
+    std::atomic<bool> entered{false};
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        const memory::EpochGuard guard;
+        entered = true;
+        while (!done) {
+            std::this_thread::yield();
+        }
+    });
+    while (!entered) {
+        std::this_thread::yield();
+    }
+
+    memory::retire(new Tracked());
+    collectAll();
+    REQUIRE(destroyed == 0);
+
+    done = true;
+    reader.join();
+    collectAll();
+    REQUIRE(destroyed == 1);
+}
+
+TEST_CASE("Objects retired by exited threads are freed by others", "[epoch]") {
+    collectAll();
+    destroyed = 0;
+
+    {
+        const memory::EpochGuard guard;
+        // Fewer than trigger a collection, so the thread leaves all of them behind when it exits
+        std::thread([] {
+            for (int i = 0; i < 10; ++i) {
+                memory::retire(new Tracked());
+            }
+        }).join();
+
+        // The orphans still wait for the guard that was active when they were retired
+        collectAll();
+        REQUIRE(destroyed == 0);
+    }
+    collectAll();
+    REQUIRE(destroyed == 10);
+
+    // The record of the exited thread is reused by the next one
+    std::thread([] {
+        memory::retire(new Tracked());
+        collectAll();
+    }).join();
+    REQUIRE(destroyed == 11);
+}
+
+TEST_CASE("Readers never see freed objects", "[epoch]") {
+    struct Node {
+        std::atomic<bool> alive{true};
+        ~Node() { alive = false; }
+    };
+
+    std::atomic<Node*> shared{new Node()};
+    std::atomic<bool> done{false};
+    std::atomic<size_t> failures{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.emplace_back([&] {
+            while (!done) {
+                const memory::EpochGuard guard;
+                const Node* node = shared.load(std::memory_order_acquire);
+                if (!node->alive) {
+                    ++failures;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 20000; ++i) {
+        memory::retire(shared.exchange(new Node(), std::memory_order_acq_rel));
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    delete shared.load();
+    REQUIRE(failures == 0);
+}